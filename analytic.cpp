@@ -0,0 +1,143 @@
+#include "analytic.h"
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "trace.h"
+
+namespace {
+
+// The CPU-only processes of a workload as columns in arrival order
+struct CpuOnlyJobs {
+    std::vector<std::uint32_t> inputOrders;
+    std::vector<int> ids;
+    std::vector<int> arrivalTimes;
+    std::vector<int> bursts;
+};
+
+// Single burst of a process, or false if it has none or more than one
+bool singleBurst(const BurstRange& range, int& burst) {
+    std::int32_t value;
+    if (range.begin == range.end || decodeBurst(range.begin, range.end, range.encoding, value) != range.end) {
+        return false;
+    }
+    burst = value;
+    return true;
+}
+
+bool collectJobs(const Workload& workload, CpuOnlyJobs& jobs) {
+    if (workload.generated || workload.text) {
+        return false;
+    }
+    
+    std::size_t count = workload.trace ? workload.trace->size() : workload.processes.size();
+    jobs.inputOrders.resize(count);
+    jobs.ids.resize(count);
+    jobs.arrivalTimes.resize(count);
+    jobs.bursts.resize(count);
+    for (std::size_t rank = 0; rank < count; rank++) {
+        std::size_t index = workload.arrivalOrder.empty() ? rank : workload.arrivalOrder[rank];
+        BurstRange range;
+        if (workload.trace) {
+            jobs.ids[rank] = workload.trace->getId(index);
+            jobs.arrivalTimes[rank] = workload.trace->getArrivalTime(index);
+            range = workload.trace->burstRange(index);
+        } else {
+            jobs.ids[rank] = workload.processes.ids[index];
+            jobs.arrivalTimes[rank] = workload.processes.arrivalTimes[index];
+            range = workload.processes.bursts.range(index);
+        }
+        jobs.inputOrders[rank] = static_cast<std::uint32_t>(index);
+        if (!singleBurst(range, jobs.bursts[rank])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Accounts for job rank running from start; returns its finish time
+int runJob(const CpuOnlyJobs& jobs, std::size_t rank, int start, int processSwitchTime, Statistics& stats) {
+    int finish = start + jobs.bursts[rank];
+    
+    ProcessOutcome outcome;
+    ProcessRecord& record = outcome.record;
+    record.inputOrder = jobs.inputOrders[rank];
+    record.id = jobs.ids[rank];
+    record.arrivalTime = jobs.arrivalTimes[rank];
+    record.serviceTime = jobs.bursts[rank];
+    record.ioTime = 0;
+    record.turnaroundTime = finish - record.arrivalTime;
+    record.finishTime = finish;
+    outcome.waitTime = start - record.arrivalTime;
+    outcome.responseTime = start - record.arrivalTime;
+    
+    // The simulator charges the CPU when the burst is dispatched and the
+    // switch when it completes
+    stats.addCpuBusyTime(jobs.bursts[rank]);
+    stats.addCoreBusyTime(0, jobs.bursts[rank]);
+    stats.addProcessSwitchTime(processSwitchTime);
+    stats.addOutcome(outcome);
+    return finish;
+}
+
+} // namespace
+
+bool evaluateAnalytically(const std::string& algorithm, const Workload& workload,
+                          const SimulationOptions& options, Statistics& stats) {
+    bool sjf = algorithm == "SJF";
+    if ((!sjf && algorithm != "FCFS") || options.numCores != 1 || options.verboseMode ||
+        !options.timelineFile.empty() || options.checkpointInterval > 0 || !options.restoreFile.empty()) {
+        return false;
+    }
+    
+    CpuOnlyJobs jobs;
+    if (!collectJobs(workload, jobs)) {
+        return false;
+    }
+    int processSwitchTime = options.processSwitchTime >= 0 ? options.processSwitchTime
+                                                           : workload.processSwitchTime;
+    
+    Statistics result;
+    result.setRecordProcesses(options.detailedMode);
+    std::size_t count = jobs.bursts.size();
+    int finish = 0;
+    if (!sjf) {
+        // A job arriving no later than its predecessor finishes was queued
+        // and starts after the switch; one arriving later found the CPU idle
+        for (std::size_t rank = 0; rank < count; rank++) {
+            int arrival = jobs.arrivalTimes[rank];
+            int start = rank == 0 || arrival > finish ? arrival : finish + processSwitchTime;
+            finish = runJob(jobs, rank, start, processSwitchTime, result);
+        }
+    } else {
+        // Jobs that have arrived by the time the CPU frees up, shortest first
+        // and in arrival order among equals, as in SJFScheduler
+        using Job = std::pair<int, std::size_t>;
+        std::priority_queue<Job, std::vector<Job>, std::greater<Job>> ready;
+        std::size_t next = 0;
+        while (next < count || !ready.empty()) {
+            std::size_t rank;
+            int start;
+            if (ready.empty()) {
+                rank = next++;
+                start = jobs.arrivalTimes[rank];
+            } else {
+                rank = ready.top().second;
+                ready.pop();
+                start = finish + processSwitchTime;
+            }
+            finish = runJob(jobs, rank, start, processSwitchTime, result);
+            
+            for (; next < count && jobs.arrivalTimes[next] <= finish; next++) {
+                ready.push(Job(jobs.bursts[next], next));
+            }
+        }
+    }
+    
+    // The run ends after the last switch
+    result.setTotalTime(count > 0 ? finish + processSwitchTime : 0);
+    result.sortProcesses();
+    stats = result;
+    return true;
+}
@@ -0,0 +1,24 @@
+#ifndef ANALYTIC_H
+#define ANALYTIC_H
+
+#include <string>
+#include "simulator.h"
+#include "statistics.h"
+#include "workload.h"
+
+// Closed-form evaluation of the non-preemptive policies (FCFS and SJF) on one
+// CPU when no process has an I/O burst. Each process then runs exactly once,
+// so its start time follows from the finish time of the process before it:
+// its arrival time if the CPU went idle before it arrived, otherwise that
+// finish time plus the switch overhead. FCFS takes processes in arrival
+// order; SJF takes the shortest job that has arrived from a heap. Neither
+// needs the event queue, the process table or the run queues.
+//
+// Fills stats with exactly what a Simulator run would produce and returns
+// true, or returns false without touching stats when the run is not of this
+// kind (another algorithm, several cores, verbose tracing, a timeline,
+// checkpoints, lazy or generated input, or a process with I/O).
+bool evaluateAnalytically(const std::string& algorithm, const Workload& workload,
+                          const SimulationOptions& options, Statistics& stats);
+
+#endif // ANALYTIC_H
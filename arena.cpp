@@ -0,0 +1,36 @@
+#include "arena.h"
+
+SimulationArena::SimulationArena()
+    : upstream(std::pmr::get_default_resource()), buffer(INITIAL_BUFFER_SIZE, upstream), freeLists{} {
+}
+
+void* SimulationArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    if (!isSmall(bytes, alignment)) {
+        return upstream->allocate(bytes, alignment);
+    }
+    
+    std::size_t index = sizeClass(bytes);
+    FreeBlock* block = freeLists[index];
+    if (block) {
+        freeLists[index] = block->next;
+        return block;
+    }
+    return buffer.allocate((index + 1) * GRANULE, GRANULE);
+}
+
+void SimulationArena::do_deallocate(void* block, std::size_t bytes, std::size_t alignment) {
+    if (!isSmall(bytes, alignment)) {
+        upstream->deallocate(block, bytes, alignment);
+        return;
+    }
+    
+    // The block stays in the buffer and is reused for the next request of its class
+    std::size_t index = sizeClass(bytes);
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    freed->next = freeLists[index];
+    freeLists[index] = freed;
+}
+
+bool SimulationArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
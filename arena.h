@@ -0,0 +1,51 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+
+// Memory of one simulation run. Containers of the run (process table, event
+// queue, run queues, statistics) allocate from it, and it is released all at
+// once when the run ends. Small blocks (queue and tree nodes, specs, map
+// entries) are carved out of a monotonic buffer; a freed block goes onto the
+// free list of its size class and is handed out again, so alloc and free are
+// both O(1) and never reach the system allocator. Large blocks, which are
+// mostly vector storage that gets outgrown, go straight to the upstream heap
+// so the buffer doesn't keep every abandoned copy. Not thread-safe; each run
+// owns one.
+class SimulationArena : public std::pmr::memory_resource {
+private:
+    static constexpr std::size_t INITIAL_BUFFER_SIZE = 1 << 20;
+    static constexpr std::size_t GRANULE = alignof(std::max_align_t);
+    static constexpr std::size_t LARGEST_SMALL_BLOCK = 1024;
+    static constexpr std::size_t SIZE_CLASSES = LARGEST_SMALL_BLOCK / GRANULE;
+    
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    
+    std::pmr::memory_resource* upstream;
+    std::pmr::monotonic_buffer_resource buffer;
+    FreeBlock* freeLists[SIZE_CLASSES];
+    
+    static bool isSmall(std::size_t bytes, std::size_t alignment) {
+        return bytes <= LARGEST_SMALL_BLOCK && alignment <= GRANULE;
+    }
+    static std::size_t sizeClass(std::size_t bytes) {
+        return bytes == 0 ? 0 : (bytes - 1) / GRANULE;
+    }
+    
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* block, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    SimulationArena();
+    
+    SimulationArena(const SimulationArena&) = delete;
+    SimulationArena& operator=(const SimulationArena&) = delete;
+    
+    std::pmr::memory_resource* resource() { return this; }
+};
+
+#endif // ARENA_H
@@ -0,0 +1,212 @@
+#include "arrival.h"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+#include "snapshot.h"
+#include "trace.h"
+
+namespace {
+
+// Tags checkpoints with the kind of source that wrote them
+enum class SourceKind : std::uint8_t {
+    SPEC,
+    TRACE,
+    TEXT,
+    RANDOM
+};
+
+void saveSourceHeader(SnapshotWriter& out, SourceKind kind, std::uint64_t processCount) {
+    out.write(kind);
+    out.write(processCount);
+}
+
+void restoreSourceHeader(SnapshotReader& in, SourceKind kind, std::uint64_t processCount) {
+    bool sameKind = in.read<SourceKind>() == kind;
+    bool sameCount = in.read<std::uint64_t>() == processCount;
+    in.expect(sameKind && sameCount, "checkpoint was taken with a different workload");
+}
+
+} // namespace
+
+// Spec source
+SpecArrivalSource::SpecArrivalSource(const Workload& workload)
+    : workload(workload), next(0) {
+}
+
+ProcessHandle SpecArrivalSource::admitNext(ProcessTable& table) {
+    if (next >= workload.processes.size()) {
+        return NO_PROCESS;
+    }
+    
+    std::size_t index = workload.arrivalOrder.empty() ? next : workload.arrivalOrder[next];
+    next++;
+    const ProcessColumns& processes = workload.processes;
+    return table.add(processes.ids[index], index, processes.arrivalTimes[index], processes.nices[index],
+                     processes.bursts.range(index));
+}
+
+void SpecArrivalSource::save(SnapshotWriter& out) const {
+    saveSourceHeader(out, SourceKind::SPEC, workload.processes.size());
+    out.write<std::uint64_t>(next);
+}
+
+void SpecArrivalSource::restore(SnapshotReader& in) {
+    restoreSourceHeader(in, SourceKind::SPEC, workload.processes.size());
+    next = static_cast<std::size_t>(in.readSize(workload.processes.size()));
+}
+
+// Trace source
+TraceArrivalSource::TraceArrivalSource(const Workload& workload)
+    : workload(workload), next(0) {
+}
+
+ProcessHandle TraceArrivalSource::admitNext(ProcessTable& table) {
+    if (next >= workload.trace->size()) {
+        return NO_PROCESS;
+    }
+    
+    std::size_t index = workload.arrivalOrder.empty() ? next : workload.arrivalOrder[next];
+    next++;
+    return table.add(*workload.trace, index);
+}
+
+void TraceArrivalSource::save(SnapshotWriter& out) const {
+    saveSourceHeader(out, SourceKind::TRACE, workload.trace->size());
+    out.write<std::uint64_t>(next);
+}
+
+void TraceArrivalSource::restore(SnapshotReader& in) {
+    restoreSourceHeader(in, SourceKind::TRACE, workload.trace->size());
+    next = static_cast<std::size_t>(in.readSize(workload.trace->size()));
+}
+
+// Streaming text source
+TextArrivalSource::TextArrivalSource(const Workload& workload, std::pmr::memory_resource* memory)
+    : reader(workload.text->data(), workload.text->data() + workload.text->size()),
+      memory(memory), next(0), lastArrivalTime(0) {
+}
+
+ProcessHandle TextArrivalSource::admitNext(ProcessTable& table) {
+    std::shared_ptr<const ProcessSpec> spec;
+    if (!reader.next(spec, memory)) {
+        return NO_PROCESS;
+    }
+    
+    if (next > 0 && spec->arrivalTime < lastArrivalTime) {
+        throw std::runtime_error("Streamed input is not in arrival order at process " +
+                                 std::to_string(spec->id));
+    }
+    lastArrivalTime = spec->arrivalTime;
+    
+    return table.add(std::move(spec), next++);
+}
+
+void TextArrivalSource::save(SnapshotWriter& out) const {
+    saveSourceHeader(out, SourceKind::TEXT, static_cast<std::uint64_t>(reader.getProcessCount()));
+    out.write<std::uint64_t>(reader.getOffset());
+    out.write(reader.getProcessesRead());
+    out.write<std::uint64_t>(next);
+    out.write(lastArrivalTime);
+}
+
+void TextArrivalSource::restore(SnapshotReader& in) {
+    restoreSourceHeader(in, SourceKind::TEXT, static_cast<std::uint64_t>(reader.getProcessCount()));
+    std::uint64_t offset = in.read<std::uint64_t>();
+    int processesRead = in.read<int>();
+    in.expect(reader.seek(static_cast<std::size_t>(offset), processesRead), "corrupt checkpoint");
+    next = static_cast<std::size_t>(in.read<std::uint64_t>());
+    in.read(lastArrivalTime);
+}
+
+// Random source
+namespace {
+
+// Expands a 64-bit seed into the full generator state
+std::mt19937 seededGenerator(std::uint64_t seed) {
+    std::seed_seq sequence{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)};
+    return std::mt19937(sequence);
+}
+
+} // namespace
+
+RandomArrivalSource::RandomArrivalSource(const GeneratorSettings& settings,
+                                         std::pmr::memory_resource* memory)
+    : settings(settings),
+      memory(memory),
+      rng(seededGenerator(settings.seed)),
+      arrivalDist(1.0 / 50.0),      // Exponential arrival intervals (mean 50)
+      cpuBurstDist(5, 500),
+      ioBurstDist(30, 1000),
+      numBurstsDist(10, 30),        // Average around 20
+      nextId(1),
+      currentArrivalTime(0) {
+}
+
+ProcessHandle RandomArrivalSource::admitNext(ProcessTable& table) {
+    if (nextId > settings.numProcesses) {
+        return NO_PROCESS;
+    }
+    
+    // Generate arrival time based on exponential distribution
+    int arrivalInterval = static_cast<int>(std::ceil(arrivalDist(rng)));
+    currentArrivalTime += arrivalInterval;
+    
+    // Generate number of CPU bursts for this process
+    int numBursts = numBurstsDist(rng);
+    
+    cpuBursts.clear();
+    ioBursts.clear();
+    
+    // Generate CPU and I/O bursts
+    for (int j = 0; j < numBursts; j++) {
+        cpuBursts.push_back(cpuBurstDist(rng));
+        
+        // If this is not the last burst, generate I/O time
+        if (j < numBursts - 1) {
+            ioBursts.push_back(ioBurstDist(rng));
+        }
+    }
+    
+    int id = nextId++;
+    std::pmr::polymorphic_allocator<ProcessSpec> allocator(memory);
+    return table.add(std::allocate_shared<ProcessSpec>(allocator, id, currentArrivalTime,
+                                                       cpuBursts, ioBursts, 0, memory),
+                     static_cast<std::uint64_t>(id - 1));
+}
+
+void RandomArrivalSource::save(SnapshotWriter& out) const {
+    saveSourceHeader(out, SourceKind::RANDOM, static_cast<std::uint64_t>(settings.numProcesses));
+    
+    // The standard text form of the engine and distributions is exact
+    std::ostringstream state;
+    state << rng << ' ' << arrivalDist << ' ' << cpuBurstDist << ' ' << ioBurstDist << ' ' << numBurstsDist;
+    out.writeString(state.str());
+    out.write(nextId);
+    out.write(currentArrivalTime);
+}
+
+void RandomArrivalSource::restore(SnapshotReader& in) {
+    restoreSourceHeader(in, SourceKind::RANDOM, static_cast<std::uint64_t>(settings.numProcesses));
+    
+    std::istringstream state(in.readString());
+    state >> rng >> arrivalDist >> cpuBurstDist >> ioBurstDist >> numBurstsDist;
+    in.expect(!state.fail(), "corrupt checkpoint");
+    in.read(nextId);
+    in.read(currentArrivalTime);
+}
+
+std::unique_ptr<ArrivalSource> openArrivalSource(const Workload& workload,
+                                                 std::pmr::memory_resource* memory) {
+    if (workload.generated) {
+        return std::unique_ptr<ArrivalSource>(new RandomArrivalSource(workload.generator, memory));
+    } else if (workload.trace) {
+        return std::unique_ptr<ArrivalSource>(new TraceArrivalSource(workload));
+    } else if (workload.text) {
+        return std::unique_ptr<ArrivalSource>(new TextArrivalSource(workload, memory));
+    } else {
+        return std::unique_ptr<ArrivalSource>(new SpecArrivalSource(workload));
+    }
+}
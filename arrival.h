@@ -0,0 +1,110 @@
+#ifndef ARRIVAL_H
+#define ARRIVAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <vector>
+#include "parser.h"
+#include "process.h"
+#include "workload.h"
+
+class SnapshotReader;
+class SnapshotWriter;
+
+// Supplies processes to a simulation run lazily, in arrival-time order (ties
+// in input order). The simulator admits one process at a time, so only the
+// processes that have arrived and not yet terminated occupy the ProcessTable.
+class ArrivalSource {
+public:
+    virtual ~ArrivalSource() = default;
+    
+    // Adds the next process to the table; NO_PROCESS once the source is exhausted
+    virtual ProcessHandle admitNext(ProcessTable& table) = 0;
+    
+    // Position in the workload, for checkpoints. restore expects a fresh
+    // source over the same workload and throws std::runtime_error otherwise.
+    virtual void save(SnapshotWriter& out) const = 0;
+    virtual void restore(SnapshotReader& in) = 0;
+    
+    // Number of processes admitted so far
+    virtual std::uint64_t admittedCount() const = 0;
+};
+
+// Processes parsed into memory
+class SpecArrivalSource : public ArrivalSource {
+private:
+    const Workload& workload;
+    std::size_t next;
+
+public:
+    explicit SpecArrivalSource(const Workload& workload);
+    ProcessHandle admitNext(ProcessTable& table) override;
+    void save(SnapshotWriter& out) const override;
+    void restore(SnapshotReader& in) override;
+    std::uint64_t admittedCount() const override { return next; }
+};
+
+// Processes read straight out of a mapped binary trace
+class TraceArrivalSource : public ArrivalSource {
+private:
+    const Workload& workload;
+    std::size_t next;
+
+public:
+    explicit TraceArrivalSource(const Workload& workload);
+    ProcessHandle admitNext(ProcessTable& table) override;
+    void save(SnapshotWriter& out) const override;
+    void restore(SnapshotReader& in) override;
+    std::uint64_t admittedCount() const override { return next; }
+};
+
+// Processes parsed from mapped text only when they are admitted. The input
+// must already be in arrival order; a process arriving earlier than its
+// predecessor raises std::runtime_error.
+class TextArrivalSource : public ArrivalSource {
+private:
+    TextWorkloadReader reader;
+    std::pmr::memory_resource* memory;  // Backs the specs of admitted processes
+    std::size_t next;
+    int lastArrivalTime;
+
+public:
+    TextArrivalSource(const Workload& workload, std::pmr::memory_resource* memory);
+    ProcessHandle admitNext(ProcessTable& table) override;
+    void save(SnapshotWriter& out) const override;
+    void restore(SnapshotReader& in) override;
+    std::uint64_t admittedCount() const override { return next; }
+};
+
+// Random processes generated on demand from a seed
+class RandomArrivalSource : public ArrivalSource {
+private:
+    GeneratorSettings settings;
+    std::pmr::memory_resource* memory;  // Backs the specs of admitted processes
+    std::mt19937 rng;
+    std::exponential_distribution<double> arrivalDist;
+    std::uniform_int_distribution<int> cpuBurstDist;
+    std::uniform_int_distribution<int> ioBurstDist;
+    std::uniform_int_distribution<int> numBurstsDist;
+    int nextId;
+    int currentArrivalTime;
+    std::vector<int> cpuBursts;     // Scratch space reused for every process
+    std::vector<int> ioBursts;
+
+public:
+    RandomArrivalSource(const GeneratorSettings& settings, std::pmr::memory_resource* memory);
+    ProcessHandle admitNext(ProcessTable& table) override;
+    void save(SnapshotWriter& out) const override;
+    void restore(SnapshotReader& in) override;
+    std::uint64_t admittedCount() const override { return static_cast<std::uint64_t>(nextId - 1); }
+};
+
+// Creates a fresh source over the workload for one simulation run. Processes
+// the source creates itself are allocated from memory, usually the run's arena.
+std::unique_ptr<ArrivalSource> openArrivalSource(const Workload& workload,
+                                                 std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+#endif // ARRIVAL_H
@@ -0,0 +1,222 @@
+// Throughput benchmark for the simulation engine.
+//
+// Generates synthetic workloads of increasing size and times Simulator::run()
+// for each scheduler. Results are written as CSV so they can be saved and
+// compared against a later run:
+//
+//   sim_bench [-n max_processes] [-a algorithm] [-r repetitions] [-b baseline.csv] [-V]
+//
+// -V runs through the virtual Scheduler interface instead of the Simulator
+// specialised on the concrete scheduler, to measure the cost of dispatch.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <unistd.h>
+#include "arena.h"
+#include "arrival.h"
+#include "scheduler.h"
+#include "simulator.h"
+#include "workload.h"
+
+namespace {
+
+struct BenchResult {
+    std::string algorithm;
+    long long processes;
+    std::uint64_t events;
+    double seconds;
+    long long peakRssKb;
+    long long startRssKb;   // Resident set before the run, excluded from bytes/process
+    
+    double eventsPerSecond() const { return seconds > 0 ? events / seconds : 0.0; }
+    double nsPerEvent() const { return events > 0 ? seconds * 1e9 / events : 0.0; }
+    double bytesPerProcess() const {
+        return processes > 0 ? std::max(0LL, peakRssKb - startRssKb) * 1024.0 / processes : 0.0;
+    }
+};
+
+// Reads a "<field>: <value> kB" line from /proc/self/status, 0 if unavailable
+long long readStatusKb(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0 && line.size() > field.size() &&
+            line[field.size()] == ':') {
+            return std::atoll(line.c_str() + field.size() + 1);
+        }
+    }
+    return 0;
+}
+
+// Resets the peak RSS high-water mark so each run is measured on its own
+void resetPeakRss() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+template <typename Policy>
+BenchResult timeRun(std::shared_ptr<Policy> scheduler, const Workload& workload,
+                    std::pmr::memory_resource* memory) {
+    SimulationOptions options;
+    std::vector<std::shared_ptr<Policy>> schedulers{scheduler};
+    std::unique_ptr<ArrivalSource> arrivals = openArrivalSource(workload, memory);
+    std::ostream discard(nullptr);
+    
+    resetPeakRss();
+    long long startRssKb = readStatusKb("VmRSS");
+    Simulator<Policy> simulator(options, schedulers, *arrivals, discard, memory);
+    auto start = std::chrono::steady_clock::now();
+    simulator.run();
+    auto stop = std::chrono::steady_clock::now();
+    
+    BenchResult result;
+    result.events = simulator.getEventCount();
+    result.seconds = std::chrono::duration<double>(stop - start).count();
+    result.peakRssKb = readStatusKb("VmHWM");
+    result.startRssKb = startRssKb;
+    return result;
+}
+
+BenchResult runOnce(const std::string& algorithm, int numProcesses, bool virtualDispatch) {
+    Workload workload;
+    workload.processSwitchTime = 5;
+    workload.generated = true;
+    workload.generator.numProcesses = numProcesses;
+    workload.generator.seed = 1;
+    
+    // Same per-run arena as runSimulation
+    SimulationArena arena;
+    std::pmr::memory_resource* memory = arena.resource();
+    
+    BenchResult result;
+    if (virtualDispatch) {
+        result = timeRun(createScheduler(algorithm, workload.processSwitchTime, memory), workload, memory);
+    } else {
+        result = std::visit([&](auto&& prototype) {
+            using Policy = std::decay_t<decltype(prototype)>;
+            return timeRun(std::make_shared<Policy>(std::move(prototype)), workload, memory);
+        }, createSchedulerPolicy(algorithm, workload.processSwitchTime, memory));
+    }
+    result.algorithm = algorithm;
+    result.processes = numProcesses;
+    return result;
+}
+
+// Loads ns/event figures keyed by "algorithm,processes" from a previous run
+std::map<std::string, double> loadBaseline(const std::string& path) {
+    std::map<std::string, double> baseline;
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open baseline " + path);
+    }
+    
+    std::string line;
+    std::getline(in, line);     // Header
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::stringstream row(line);
+        std::string field;
+        while (std::getline(row, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() >= 6) {
+            baseline[fields[0] + "," + fields[1]] = std::atof(fields[5].c_str());
+        }
+    }
+    return baseline;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long long maxProcesses = 10000000;
+    std::vector<std::string> algorithms = {"FCFS", "SJF", "SRTN", "RR10", "RR50", "RR100"};
+    int repetitions = 1;
+    std::string baselinePath;
+    bool virtualDispatch = false;
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "n:a:r:b:V")) != -1) {
+        switch (opt) {
+            case 'n':
+                maxProcesses = std::atoll(optarg);
+                break;
+            case 'a':
+                algorithms = {optarg};
+                break;
+            case 'r':
+                repetitions = std::max(1, std::atoi(optarg));
+                break;
+            case 'b':
+                baselinePath = optarg;
+                break;
+            case 'V':
+                virtualDispatch = true;
+                break;
+            default:
+                std::cerr << "Usage: " << argv[0]
+                          << " [-n max_processes] [-a algorithm] [-r repetitions] [-b baseline.csv] [-V]\n";
+                return EXIT_FAILURE;
+        }
+    }
+    
+    std::map<std::string, double> baseline;
+    try {
+        if (!baselinePath.empty()) {
+            baseline = loadBaseline(baselinePath);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    
+    std::cout << "algorithm,processes,events,seconds,events_per_sec,ns_per_event,"
+              << "peak_rss_kb,bytes_per_process";
+    if (!baselinePath.empty()) {
+        std::cout << ",baseline_ns_per_event,change_pct";
+    }
+    std::cout << "\n";
+    
+    for (long long processes = 1000; processes <= maxProcesses; processes *= 10) {
+        for (const auto& algorithm : algorithms) {
+            // Keep the fastest repetition to reduce noise
+            BenchResult best;
+            for (int rep = 0; rep < repetitions; rep++) {
+                BenchResult result = runOnce(algorithm, static_cast<int>(processes), virtualDispatch);
+                if (rep == 0 || result.seconds < best.seconds) {
+                    best = result;
+                }
+            }
+            
+            std::cout << best.algorithm << "," << best.processes << "," << best.events << ","
+                      << best.seconds << "," << static_cast<long long>(best.eventsPerSecond()) << ","
+                      << best.nsPerEvent() << "," << best.peakRssKb << ","
+                      << best.bytesPerProcess();
+            if (!baselinePath.empty()) {
+                auto entry = baseline.find(best.algorithm + "," + std::to_string(best.processes));
+                if (entry != baseline.end() && entry->second > 0) {
+                    std::cout << "," << entry->second << ","
+                              << (best.nsPerEvent() - entry->second) / entry->second * 100.0;
+                } else {
+                    std::cout << ",,";
+                }
+            }
+            std::cout << std::endl;
+        }
+    }
+    
+    return EXIT_SUCCESS;
+}
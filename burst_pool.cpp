@@ -0,0 +1,105 @@
+#include "burst_pool.h"
+
+namespace {
+
+// Calls visit(burst) for every burst of a process in execution order
+template <typename Visitor>
+void forEachBurst(const std::vector<int>& cpuBursts, const std::vector<int>& ioBursts, Visitor visit) {
+    for (std::size_t j = 0; j < cpuBursts.size(); j++) {
+        visit(cpuBursts[j]);
+        if (j < ioBursts.size()) {
+            visit(ioBursts[j]);
+        }
+    }
+}
+
+bool fitsInUint16(int burst) {
+    return burst >= 0 && burst <= 0xffff;
+}
+
+void appendUint16(int burst, std::pmr::vector<std::uint8_t>& out) {
+    out.push_back(static_cast<std::uint8_t>(burst & 0xff));
+    out.push_back(static_cast<std::uint8_t>(burst >> 8));
+}
+
+} // namespace
+
+BurstEncoding chooseBurstEncoding(const std::vector<int>& cpuBursts, const std::vector<int>& ioBursts) {
+    bool fits = true;
+    std::size_t count = 0;
+    std::size_t varintBytes = 0;
+    std::uint8_t encoded[8];
+    forEachBurst(cpuBursts, ioBursts, [&](int burst) {
+        fits = fits && fitsInUint16(burst);
+        count++;
+        varintBytes += encodeVarint(burst, encoded);
+    });
+    return fits && 2 * count <= varintBytes ? BurstEncoding::UINT16 : BurstEncoding::VARINT;
+}
+
+void appendBursts(const std::vector<int>& cpuBursts, const std::vector<int>& ioBursts,
+                  BurstEncoding encoding, std::pmr::vector<std::uint8_t>& out) {
+    std::uint8_t encoded[8];
+    forEachBurst(cpuBursts, ioBursts, [&](int burst) {
+        if (encoding == BurstEncoding::UINT16) {
+            appendUint16(burst, out);
+        } else {
+            std::size_t n = encodeVarint(burst, encoded);
+            out.insert(out.end(), encoded, encoded + n);
+        }
+    });
+}
+
+void decodeBursts(const BurstRange& bursts, std::vector<int>& cpuBursts, std::vector<int>& ioBursts) {
+    cpuBursts.clear();
+    ioBursts.clear();
+    const std::uint8_t* cursor = bursts.begin;
+    while (cursor != bursts.end) {
+        std::int32_t burst;
+        cursor = decodeBurst(cursor, bursts.end, bursts.encoding, burst);
+        (cpuBursts.size() == ioBursts.size() ? cpuBursts : ioBursts).push_back(burst);
+    }
+}
+
+BurstPool::BurstPool()
+    : offsets(1, 0), encoding(BurstEncoding::VARINT), burstCount(0), fitsUint16(true) {
+}
+
+void BurstPool::add(const std::vector<int>& cpuBursts, const std::vector<int>& ioBursts) {
+    appendBursts(cpuBursts, ioBursts, BurstEncoding::VARINT, bytes);
+    offsets.push_back(bytes.size());
+    
+    forEachBurst(cpuBursts, ioBursts, [this](int burst) {
+        burstCount++;
+        fitsUint16 = fitsUint16 && fitsInUint16(burst);
+    });
+}
+
+void BurstPool::finish() {
+    if (encoding != BurstEncoding::VARINT || !fitsUint16 || 2 * burstCount > bytes.size()) {
+        bytes.shrink_to_fit();
+        return;
+    }
+    
+    // Every burst fits in 16 bits: re-encode in place of the varints
+    std::pmr::vector<std::uint8_t> fixed(bytes.get_allocator());
+    fixed.reserve(2 * burstCount);
+    for (std::size_t i = 0; i + 1 < offsets.size(); i++) {
+        const std::uint8_t* cursor = bytes.data() + offsets[i];
+        const std::uint8_t* end = bytes.data() + offsets[i + 1];
+        offsets[i] = fixed.size();
+        while (cursor != end) {
+            std::int32_t burst;
+            cursor = decodeVarint(cursor, end, burst);
+            appendUint16(burst, fixed);
+        }
+    }
+    offsets.back() = fixed.size();
+    
+    bytes.swap(fixed);
+    encoding = BurstEncoding::UINT16;
+}
+
+void BurstPool::reserve(std::size_t processCount) {
+    offsets.reserve(processCount + 1);
+}
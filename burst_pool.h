@@ -0,0 +1,105 @@
+#ifndef BURST_POOL_H
+#define BURST_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// How a run of bursts is laid out in memory. A process's bursts are always
+// stored interleaved in the order they are used: cpu, io, cpu, ..., cpu.
+enum class BurstEncoding : std::uint8_t {
+    VARINT,     // Zigzag varints, as in binary traces
+    UINT16      // Fixed 16 bits, little-endian; only when every burst is 0..65535
+};
+
+// The encoded bursts of one process
+struct BurstRange {
+    const std::uint8_t* begin;
+    const std::uint8_t* end;
+    BurstEncoding encoding;
+};
+
+// Appends a zigzag varint encoding of value
+inline std::size_t encodeVarint(std::int32_t value, std::uint8_t* out) {
+    std::uint32_t bits = (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+    std::size_t n = 0;
+    while (bits >= 0x80) {
+        out[n++] = static_cast<std::uint8_t>(bits | 0x80);
+        bits >>= 7;
+    }
+    out[n++] = static_cast<std::uint8_t>(bits);
+    return n;
+}
+
+// Decodes one zigzag varint; never reads at or past end
+inline const std::uint8_t* decodeVarint(const std::uint8_t* in, const std::uint8_t* end,
+                                        std::int32_t& value) {
+    std::uint32_t bits = 0;
+    int shift = 0;
+    while (in != end && shift < 35) {
+        std::uint8_t byte = *in++;
+        bits |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    value = static_cast<std::int32_t>((bits >> 1) ^ (~(bits & 1) + 1));
+    return in;
+}
+
+// Decodes the burst at in; never reads at or past end
+inline const std::uint8_t* decodeBurst(const std::uint8_t* in, const std::uint8_t* end,
+                                       BurstEncoding encoding, std::int32_t& value) {
+    if (encoding == BurstEncoding::UINT16) {
+        if (end - in < 2) {
+            value = 0;
+            return end;
+        }
+        value = static_cast<std::int32_t>(in[0] | (in[1] << 8));
+        return in + 2;
+    }
+    return decodeVarint(in, end, value);
+}
+
+// Picks the smaller encoding for the given bursts, 16-bit on a tie
+BurstEncoding chooseBurstEncoding(const std::vector<int>& cpuBursts, const std::vector<int>& ioBursts);
+
+// Appends the interleaved bursts of one process to out
+void appendBursts(const std::vector<int>& cpuBursts, const std::vector<int>& ioBursts,
+                  BurstEncoding encoding, std::pmr::vector<std::uint8_t>& out);
+
+// Splits encoded bursts back into cpu and io bursts, replacing their contents
+void decodeBursts(const BurstRange& bursts, std::vector<int>& cpuBursts, std::vector<int>& ioBursts);
+
+// The bursts of every process of a workload in one contiguous array, process
+// after process, with an offset per process. Processes walk their range with
+// a cursor, so reading bursts is sequential and a process costs one offset
+// instead of two vectors. Bursts are stored as varints while the pool is
+// built; finish() switches to 16-bit values when every burst fits and that
+// is no larger.
+class BurstPool {
+private:
+    std::pmr::vector<std::uint8_t> bytes;
+    std::vector<std::uint64_t> offsets;     // Process i owns bytes [offsets[i], offsets[i + 1])
+    BurstEncoding encoding;
+    std::size_t burstCount;
+    bool fitsUint16;                        // Every burst added so far is 0..65535
+
+public:
+    BurstPool();
+    
+    void add(const std::vector<int>& cpuBursts, const std::vector<int>& ioBursts);
+    void finish();
+    void reserve(std::size_t processCount);
+    
+    std::size_t size() const { return offsets.size() - 1; }
+    std::size_t byteSize() const { return bytes.size(); }
+    BurstEncoding getEncoding() const { return encoding; }
+    BurstRange range(std::size_t index) const {
+        return BurstRange{bytes.data() + offsets[index], bytes.data() + offsets[index + 1], encoding};
+    }
+};
+
+#endif // BURST_POOL_H
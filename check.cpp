@@ -0,0 +1,422 @@
+// Differential tests for the simulation engine.
+//
+// Each check runs two implementations that must agree on the same input: the
+// ready-queue heap against std::priority_queue and an ordered set, the
+// calendar event queue against the binary heap, a run resumed from a
+// checkpoint against an uninterrupted one, the analytic fast path against
+// the simulator, and the text parser against inputs it must reject. The
+// simulator is also held to known totals on the sample input:
+//
+//   sim_check [input.txt]
+//
+// Prints every mismatch and exits with failure if there was any.
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "analytic.h"
+#include "arena.h"
+#include "event.h"
+#include "indexed_heap.h"
+#include "parser.h"
+#include "simulator.h"
+#include "statistics.h"
+#include "sweep.h"
+#include "workload.h"
+
+namespace {
+
+int failures = 0;
+
+void expect(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+// Random text workload in arrival order; without I/O every process has one burst
+std::string randomWorkloadText(std::uint32_t seed, int count, bool withIo) {
+    std::mt19937 random(seed);
+    std::ostringstream text;
+    text << count << " " << random() % 6 << "\n";
+    int arrival = 0;
+    for (int id = 1; id <= count; id++) {
+        arrival += static_cast<int>(random() % 15);
+        int bursts = withIo ? 1 + static_cast<int>(random() % 3) : 1;
+        text << id << " " << arrival << " " << bursts << "\n";
+        for (int burst = 1; burst <= bursts; burst++) {
+            text << burst << " " << 1 + random() % 40;
+            if (burst < bursts) {
+                text << " " << 1 + random() % 60;
+            }
+            text << "\n";
+        }
+    }
+    return text.str();
+}
+
+Workload parseText(const std::string& text) {
+    return parseWorkload(text.data(), text.data() + text.size());
+}
+
+// Pushes and pops against std::priority_queue, which has no decrease-key or
+// removal; ties must come out first in, first out
+void checkHeapOrder() {
+    using Reference = std::tuple<int, std::uint64_t, ProcessHandle>;
+    std::priority_queue<Reference, std::vector<Reference>, std::greater<Reference>> reference;
+    IndexedHeap<int> heap;
+    std::mt19937 random(1);
+    std::uint64_t sequence = 0;
+    ProcessHandle nextProcess = 0;
+    
+    for (int step = 0; step < 20000; step++) {
+        if (reference.empty() || random() % 3 != 0) {
+            int key = static_cast<int>(random() % 20);
+            heap.push(nextProcess, key);
+            reference.emplace(key, sequence++, nextProcess++);
+            continue;
+        }
+        
+        expect(heap.topKey() == std::get<0>(reference.top()), "heap top key matches priority_queue");
+        expect(heap.pop() == std::get<2>(reference.top()), "heap pops in priority_queue order");
+        reference.pop();
+    }
+    while (!reference.empty()) {
+        expect(heap.pop() == std::get<2>(reference.top()), "heap drains in priority_queue order");
+        reference.pop();
+    }
+    expect(heap.empty(), "heap is empty once drained");
+}
+
+// Every indexed operation against an ordered set of (key, sequence, process)
+void checkHeapIndex() {
+    using Reference = std::tuple<int, std::uint64_t, ProcessHandle>;
+    const ProcessHandle processes = 64;
+    std::set<Reference> reference;
+    std::map<ProcessHandle, Reference> queued;
+    IndexedHeap<int> heap;
+    std::mt19937 random(2);
+    std::uint64_t sequence = 0;
+    
+    for (int step = 0; step < 50000; step++) {
+        ProcessHandle process = random() % processes;
+        auto entry = queued.find(process);
+        int key = static_cast<int>(random() % 100);
+        
+        switch (random() % 5) {
+            case 0:
+                if (entry == queued.end()) {
+                    heap.push(process, key);
+                    Reference added(key, sequence++, process);
+                    reference.insert(added);
+                    queued[process] = added;
+                }
+                break;
+            
+            case 1:
+                if (!reference.empty()) {
+                    Reference first = *reference.begin();
+                    expect(heap.pop() == std::get<2>(first), "heap pops the smallest key");
+                    reference.erase(reference.begin());
+                    queued.erase(std::get<2>(first));
+                }
+                break;
+            
+            case 2:
+                expect(heap.remove(process) == (entry != queued.end()), "heap remove reports membership");
+                if (entry != queued.end()) {
+                    reference.erase(entry->second);
+                    queued.erase(entry);
+                }
+                break;
+            
+            case 3:
+                if (entry != queued.end() && key <= std::get<0>(entry->second)) {
+                    heap.decreaseKey(process, key);
+                    reference.erase(entry->second);
+                    entry->second = Reference(key, std::get<1>(entry->second), process);
+                    reference.insert(entry->second);
+                }
+                break;
+            
+            default:
+                if (entry != queued.end()) {
+                    heap.updateKey(process, key);
+                    reference.erase(entry->second);
+                    entry->second = Reference(key, std::get<1>(entry->second), process);
+                    reference.insert(entry->second);
+                }
+                break;
+        }
+        
+        expect(heap.size() == reference.size(), "heap size matches");
+        expect(heap.contains(process) == (queued.count(process) != 0), "heap index matches");
+        if (!reference.empty()) {
+            expect(heap.top() == std::get<2>(*reference.begin()), "heap top matches");
+        }
+        if (heap.contains(process)) {
+            expect(heap.keyOf(process) == std::get<0>(queued[process]), "heap key of a queued process matches");
+        }
+    }
+}
+
+// The same stream of additions and removals through both event queue
+// backends, with std::priority_queue as the reference order. Times jump
+// now and then so the calendar has to resize and skip empty years.
+void checkEventQueues() {
+    EventQueue heap(EventQueueKind::BINARY_HEAP);
+    EventQueue calendar(EventQueueKind::CALENDAR);
+    std::priority_queue<Event, std::vector<Event>, EventComparator> reference;
+    std::mt19937 random(3);
+    std::uint64_t sequence = 0;
+    int now = 0;
+    
+    for (int step = 0; step < 100000; step++) {
+        if (reference.empty() || random() % 2 == 0) {
+            int delay = random() % 50 == 0 ? static_cast<int>(random() % 100000)
+                                            : static_cast<int>(random() % 40);
+            Event event(static_cast<EventType>(random() % 5), now + delay,
+                        static_cast<ProcessHandle>(random() % 1000));
+            heap.addEvent(event);
+            calendar.addEvent(event);
+            event.setSequence(sequence++);
+            reference.push(event);
+            continue;
+        }
+        
+        Event expected = reference.top();
+        reference.pop();
+        Event fromHeap = heap.getNextEvent();
+        Event fromCalendar = calendar.getNextEvent();
+        now = expected.getTime();
+        expect(fromHeap.getTime() == now && fromHeap.getType() == expected.getType() &&
+               fromHeap.getProcess() == expected.getProcess() &&
+               fromHeap.getSequence() == expected.getSequence(), "binary heap pops in reference order");
+        expect(fromCalendar.getTime() == now && fromCalendar.getType() == expected.getType() &&
+               fromCalendar.getProcess() == expected.getProcess() &&
+               fromCalendar.getSequence() == expected.getSequence(), "calendar pops in reference order");
+        expect(heap.size() == reference.size() && calendar.size() == reference.size(),
+               "event queue sizes match");
+    }
+}
+
+Statistics simulate(const std::string& algorithm, const Workload& workload, const SimulationOptions& options) {
+    std::ostringstream trace;
+    return runSimulation(algorithm, workload, options, trace);
+}
+
+// Whole runs on either event queue backend
+void checkEventQueueRuns(const Workload& workload) {
+    for (const char* algorithm : {"FCFS", "SJF", "SRTN", "RR10", "MLFQ", "CFS"}) {
+        for (int cores : {1, 3}) {
+            SimulationOptions options;
+            options.detailedMode = true;
+            options.numCores = cores;
+            Statistics fromHeap = simulate(algorithm, workload, options);
+            options.eventQueue = EventQueueKind::CALENDAR;
+            std::string difference = simulate(algorithm, workload, options).compare(fromHeap);
+            expect(difference.empty(), std::string(algorithm) + " on " + std::to_string(cores) +
+                                       " cores differs between event queues in " + difference);
+        }
+    }
+}
+
+// Stops a run at its stopAt-th checkpoint, resumes it in a fresh simulator
+// and compares the result with a run that was never interrupted
+void checkCheckpoints(const Workload& workload) {
+    for (const char* algorithm : {"FCFS", "SJF", "SRTN", "RR10", "MLFQ", "CFS"}) {
+        for (int cores : {1, 2}) {
+            for (int stopAt : {1, 4, 9}) {
+                SimulationOptions options;
+                options.detailedMode = true;
+                options.numCores = cores;
+                options.checkpointInterval = 37;
+                std::string name = std::string(algorithm) + " on " + std::to_string(cores) +
+                                   " cores resumed from checkpoint " + std::to_string(stopAt);
+                
+                std::ostringstream trace;
+                SimulationArena arena;
+                Statistics uninterrupted = visitSimulation(algorithm, workload, options, trace, arena.resource(),
+                                                           [](auto& simulator, ArrivalSource&) {
+                    simulator.setCheckpointHandler([](long long) { return true; });
+                    simulator.run();
+                    return simulator.getStatistics();
+                });
+                
+                std::string checkpoint;
+                visitSimulation(algorithm, workload, options, trace, arena.resource(),
+                                [&](auto& simulator, ArrivalSource&) {
+                    int taken = 0;
+                    simulator.setCheckpointHandler([&](long long) {
+                        if (++taken < stopAt) {
+                            return true;
+                        }
+                        std::ostringstream out;
+                        simulator.saveCheckpoint(out);
+                        checkpoint = out.str();
+                        return false;
+                    });
+                    simulator.run();
+                });
+                expect(!checkpoint.empty(), name + " was taken");
+                if (checkpoint.empty()) {
+                    continue;
+                }
+                
+                Statistics resumed = visitSimulation(algorithm, workload, options, trace, arena.resource(),
+                                                     [&](auto& simulator, ArrivalSource&) {
+                    std::istringstream in(checkpoint);
+                    simulator.restoreCheckpoint(in);
+                    simulator.setCheckpointHandler([](long long) { return true; });
+                    simulator.run();
+                    return simulator.getStatistics();
+                });
+                std::string difference = resumed.compare(uninterrupted);
+                expect(difference.empty(), name + " differs in " + difference);
+            }
+        }
+    }
+}
+
+// The closed form against the simulator on workloads without I/O
+void checkAnalytic() {
+    for (std::uint32_t seed = 1; seed <= 20; seed++) {
+        Workload workload = parseText(randomWorkloadText(seed, 200, false));
+        for (const char* algorithm : {"FCFS", "SJF"}) {
+            for (bool detailed : {false, true}) {
+                SimulationOptions options;
+                options.detailedMode = detailed;
+                std::string name = std::string(algorithm) + " on workload " + std::to_string(seed);
+                
+                Statistics analytic;
+                bool evaluated = evaluateAnalytically(algorithm, workload, options, analytic);
+                expect(evaluated, name + " has a closed form");
+                if (!evaluated) {
+                    continue;
+                }
+                options.analyticFastPath = false;
+                std::string difference = analytic.compare(simulate(algorithm, workload, options));
+                expect(difference.empty(), name + " differs from the simulator in " + difference);
+            }
+        }
+    }
+    
+    // Runs the closed form does not cover are left to the simulator
+    Statistics unused;
+    SimulationOptions options;
+    expect(!evaluateAnalytically("SRTN", parseText(randomWorkloadText(1, 10, false)), options, unused),
+           "SRTN has no closed form");
+    expect(!evaluateAnalytically("FCFS", parseText(randomWorkloadText(1, 10, true)), options, unused),
+           "workloads with I/O have no closed form");
+}
+
+// Parses text that must be rejected on the given line
+void expectParseError(const std::string& text, std::size_t line, const std::string& message) {
+    try {
+        parseText(text);
+        expect(false, "parser rejects " + message);
+    } catch (const ParseError& e) {
+        expect(e.getLine() == line, "parser reports " + message + " on line " + std::to_string(line) +
+                                    ", not " + std::to_string(e.getLine()));
+        expect(std::string(e.what()).find(message) == 0, "parser reports " + message + ", not " + e.what());
+    }
+}
+
+void checkParser() {
+    expectParseError("x 0\n", 1, "Error reading input file");
+    expectParseError("3\n", 2, "Error reading input file");
+    expectParseError("2 0\n1 0 1\n1 5\n2 x 1\n1 5\n", 4, "Error reading process data");
+    expectParseError("1 0\n1 0 2\n1 5 4\n2 y\n", 4, "Error reading CPU burst data");
+    expectParseError("1 0\n1 0 2\n1 5 z\n2 3\n", 3, "Error reading I/O burst data");
+    expectParseError("1 0\n1 0 1\n1 99999999999\n", 3, "Error reading CPU burst data");
+    expectParseError("nice 1 0\n1 0 1 20\n1 5\n", 2, "Error reading nice value");
+    expectParseError("nice 1 0\n1 0 1\n1 5\n", 4, "Error reading CPU burst data");
+    
+    // Nice values are read only after the keyword
+    Workload nice = parseText("nice 2 3\n1 0 1 -5\n1 5\n2 0 1 19\n1 5\n");
+    expect(nice.processes.size() == 2 && nice.processes.nices[0] == -5 && nice.processes.nices[1] == 19,
+           "parser reads nice values");
+    Workload plain = parseText("2 3\n1 0 1\n1 5\n2 0 1\n1 5\n");
+    expect(plain.processes.size() == 2 && plain.processes.nices[0] == 0 && plain.processes.nices[1] == 0,
+           "parser defaults nice values to 0");
+    
+    // Line breaks are insignificant
+    std::string text = randomWorkloadText(4, 50, true);
+    std::string flattened = text;
+    for (char& c : flattened) {
+        if (c == '\n') {
+            c = ' ';
+        }
+    }
+    SimulationOptions options;
+    options.detailedMode = true;
+    std::string difference = simulate("SRTN", parseText(text), options)
+                                 .compare(simulate("SRTN", parseText("\t" + flattened + "\n\n"), options));
+    expect(difference.empty(), "parser ignores line breaks, but " + difference + " differs");
+}
+
+// Total times on the sample input; SJF and SRTN must differ since SRTN
+// preempts on the remaining time of the running process
+void checkSampleTotals(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    expect(static_cast<bool>(in), "sample input " + path + " opens");
+    if (!in) {
+        return;
+    }
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    Workload workload = parseText(text);
+    
+    const std::pair<const char*, int> expected[] = {
+        {"FCFS", 230}, {"SJF", 230}, {"SRTN", 255}, {"RR10", 305}, {"MLFQ", 260}, {"CFS", 244}
+    };
+    for (const auto& [algorithm, totalTime] : expected) {
+        int actual = simulate(algorithm, workload, SimulationOptions()).getTotalTime();
+        expect(actual == totalTime, std::string(algorithm) + " takes " + std::to_string(totalTime) +
+                                    " time units on the sample input, not " + std::to_string(actual));
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string samplePath = argc > 1 ? argv[1] : "input.txt";
+    Workload workload = parseText(randomWorkloadText(5, 300, true));
+    
+    const std::pair<const char*, std::function<void()>> checks[] = {
+        {"heap order", checkHeapOrder},
+        {"heap index", checkHeapIndex},
+        {"event queues", checkEventQueues},
+        {"event queue runs", [&] { checkEventQueueRuns(workload); }},
+        {"checkpoints", [&] { checkCheckpoints(workload); }},
+        {"analytic", checkAnalytic},
+        {"parser", checkParser},
+        {"sample totals", [&] { checkSampleTotals(samplePath); }},
+    };
+    for (const auto& [name, check] : checks) {
+        int before = failures;
+        try {
+            check();
+        } catch (const std::exception& e) {
+            expect(false, std::string(name) + " threw " + e.what());
+        }
+        std::cout << name << ": " << (failures == before ? "ok" : "FAILED") << "\n";
+    }
+    
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
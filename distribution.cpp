@@ -0,0 +1,124 @@
+#include "distribution.h"
+#include <algorithm>
+#include <cmath>
+#include "snapshot.h"
+
+Histogram::Histogram(std::pmr::memory_resource* memory)
+    : counts(memory), totalCount(0), minValue(UINT64_MAX), maxValue(0) {
+}
+
+std::size_t Histogram::bucketIndex(std::uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<std::size_t>(value);
+    }
+    
+    // Values in [2^e, 2^(e+1)) share 2^SUB_BUCKET_BITS buckets of width 2^(e - SUB_BUCKET_BITS)
+    int exponent = 63 - __builtin_clzll(value);
+    int shift = exponent - SUB_BUCKET_BITS;
+    return static_cast<std::size_t>((shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS));
+}
+
+std::uint64_t Histogram::bucketHighestValue(std::size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    std::uint64_t subBucket = index % SUB_BUCKETS;
+    return ((SUB_BUCKETS + subBucket + 1) << shift) - 1;
+}
+
+void Histogram::add(std::uint64_t value) {
+    std::size_t index = bucketIndex(value);
+    if (index >= counts.size()) {
+        counts.resize(index + 1, 0);
+    }
+    counts[index]++;
+    totalCount++;
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+}
+
+bool Histogram::operator==(const Histogram& other) const {
+    return counts == other.counts && totalCount == other.totalCount && minValue == other.minValue &&
+           maxValue == other.maxValue;
+}
+
+std::uint64_t Histogram::valueAtPercentile(double percent) const {
+    if (totalCount == 0) {
+        return 0;
+    }
+    
+    percent = std::min(std::max(percent, 0.0), 100.0);
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(percent / 100.0 * totalCount));
+    rank = std::max<std::uint64_t>(rank, 1);
+    
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            // Clamp the bucket bound to what was actually observed
+            return std::min(std::max(bucketHighestValue(i), minValue), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+Distribution::Distribution(std::pmr::memory_resource* memory)
+    : n(0), runningMean(0.0), m2(0.0), histogram(memory) {
+}
+
+void Distribution::add(int value) {
+    value = std::max(value, 0);
+    
+    n++;
+    double delta = value - runningMean;
+    runningMean += delta / n;
+    m2 += delta * (value - runningMean);
+    histogram.add(static_cast<std::uint64_t>(value));
+}
+
+double Distribution::variance() const {
+    return n > 1 ? m2 / (n - 1) : 0.0;
+}
+
+double Distribution::stddev() const {
+    return std::sqrt(variance());
+}
+
+int Distribution::percentile(double percent) const {
+    return static_cast<int>(histogram.valueAtPercentile(percent));
+}
+
+bool Distribution::operator==(const Distribution& other) const {
+    return n == other.n && runningMean == other.runningMean && m2 == other.m2 && histogram == other.histogram;
+}
+
+void Histogram::save(SnapshotWriter& out) const {
+    out.writeVector(counts);
+    out.write(totalCount);
+    out.write(minValue);
+    out.write(maxValue);
+}
+
+void Histogram::restore(SnapshotReader& in) {
+    in.readVector(counts);
+    in.read(totalCount);
+    in.read(minValue);
+    in.read(maxValue);
+    in.expect(counts.size() <= bucketIndex(UINT64_MAX) + 1, "corrupt checkpoint");
+}
+
+void Distribution::save(SnapshotWriter& out) const {
+    out.write(n);
+    out.write(runningMean);
+    out.write(m2);
+    histogram.save(out);
+}
+
+void Distribution::restore(SnapshotReader& in) {
+    in.read(n);
+    in.read(runningMean);
+    in.read(m2);
+    histogram.restore(in);
+}
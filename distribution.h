@@ -0,0 +1,82 @@
+#ifndef DISTRIBUTION_H
+#define DISTRIBUTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+class SnapshotReader;
+class SnapshotWriter;
+
+// Log-linear histogram of non-negative integers in the style of HdrHistogram.
+// Values below 2^SUB_BUCKET_BITS are counted exactly; larger values fall into
+// one of 2^SUB_BUCKET_BITS equal sub-buckets per power of two, so a reported
+// percentile is within 1/128 of the true value. Memory grows with the
+// logarithm of the largest value recorded, not with the number of values.
+class Histogram {
+private:
+    static constexpr int SUB_BUCKET_BITS = 7;
+    static constexpr std::uint64_t SUB_BUCKETS = std::uint64_t(1) << SUB_BUCKET_BITS;
+    
+    std::pmr::vector<std::uint64_t> counts;
+    std::uint64_t totalCount;
+    std::uint64_t minValue;
+    std::uint64_t maxValue;
+    
+    static std::size_t bucketIndex(std::uint64_t value);
+    static std::uint64_t bucketHighestValue(std::size_t index);
+    
+public:
+    explicit Histogram(std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    
+    void add(std::uint64_t value);
+    std::uint64_t count() const { return totalCount; }
+    std::uint64_t max() const { return maxValue; }
+    // Calls visit(highestValue, count) for every non-empty bucket in value order
+    template <typename Visitor>
+    void forEachBucket(Visitor visit) const {
+        for (std::size_t i = 0; i < counts.size(); i++) {
+            if (counts[i] > 0) {
+                visit(bucketHighestValue(i), counts[i]);
+            }
+        }
+    }
+    // Smallest recorded value v such that percent% of values are <= v
+    // (up to bucket resolution); 0 when empty
+    std::uint64_t valueAtPercentile(double percent) const;
+    
+    bool operator==(const Histogram& other) const;
+    
+    void save(SnapshotWriter& out) const;
+    void restore(SnapshotReader& in);
+};
+
+// Streaming summary of a sample: Welford mean and variance plus a histogram
+// for quantiles. Updated one value at a time in O(1).
+class Distribution {
+private:
+    std::uint64_t n;
+    double runningMean;
+    double m2;      // Sum of squared deviations from the running mean
+    Histogram histogram;
+    
+public:
+    explicit Distribution(std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    
+    void add(int value);    // Negative values are recorded as 0
+    
+    std::uint64_t count() const { return n; }
+    double mean() const { return runningMean; }
+    double variance() const;    // Sample variance
+    double stddev() const;
+    int percentile(double percent) const;
+    
+    // Same values added in the same order
+    bool operator==(const Distribution& other) const;
+    
+    void save(SnapshotWriter& out) const;
+    void restore(SnapshotReader& in);
+};
+
+#endif // DISTRIBUTION_H
@@ -1,7 +1,9 @@
 #include "event.h"
+#include <algorithm>
+#include "snapshot.h"
 
-Event::Event(EventType type, int time, std::shared_ptr<Process> process)
-    : type(type), time(time), process(process) {
+Event::Event(EventType type, int time, ProcessHandle process)
+    : type(type), time(time), process(process), sequence(0) {
 }
 
 EventType Event::getType() const {
@@ -12,10 +14,18 @@ int Event::getTime() const {
     return time;
 }
 
-std::shared_ptr<Process> Event::getProcess() const {
+ProcessHandle Event::getProcess() const {
     return process;
 }
 
+std::uint64_t Event::getSequence() const {
+    return sequence;
+}
+
+void Event::setSequence(std::uint64_t seq) {
+    sequence = seq;
+}
+
 std::string Event::typeToString() const {
     switch (type) {
         case EventType::PROCESS_ARRIVAL: return "Process Arrival";
@@ -27,16 +37,283 @@ std::string Event::typeToString() const {
     }
 }
 
+bool parseEventQueueKind(const std::string& name, EventQueueKind& kind) {
+    if (name == "heap") {
+        kind = EventQueueKind::BINARY_HEAP;
+    } else if (name == "calendar") {
+        kind = EventQueueKind::CALENDAR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Binary heap backend
+BinaryHeapEventQueue::BinaryHeapEventQueue(std::pmr::memory_resource* memory)
+    : events(memory) {
+}
+
+void BinaryHeapEventQueue::push(const Event& event) {
+    events.push_back(event);
+    std::push_heap(events.begin(), events.end(), EventComparator());
+}
+
+Event BinaryHeapEventQueue::pop() {
+    std::pop_heap(events.begin(), events.end(), EventComparator());
+    Event event = events.back();
+    events.pop_back();
+    return event;
+}
+
+bool BinaryHeapEventQueue::empty() const {
+    return events.empty();
+}
+
+std::size_t BinaryHeapEventQueue::size() const {
+    return events.size();
+}
+
+void BinaryHeapEventQueue::collect(std::vector<Event>& out) const {
+    out.insert(out.end(), events.begin(), events.end());
+}
+
+// Calendar queue backend
+namespace {
+
+const std::size_t MIN_BUCKETS = 2;
+const std::size_t WIDTH_SAMPLE_SIZE = 25;
+
+// True if e1 must be dequeued before e2
+bool eventBefore(const Event& e1, const Event& e2) {
+    return EventComparator()(e2, e1);
+}
+
+long long floorDiv(long long a, long long b) {
+    long long q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+} // namespace
+
+CalendarEventQueue::CalendarEventQueue(std::pmr::memory_resource* memory)
+    : buckets(MIN_BUCKETS, memory), bucketMask(MIN_BUCKETS - 1), width(1), count(0),
+      lastBucket(0), bucketTop(1), lastTime(0) {
+}
+
+std::size_t CalendarEventQueue::bucketIndex(int time) const {
+    return static_cast<std::size_t>(floorDiv(time, width)) & bucketMask;
+}
+
+void CalendarEventQueue::setCurrent(int time) {
+    long long day = floorDiv(time, width);
+    lastTime = time;
+    lastBucket = static_cast<std::size_t>(day) & bucketMask;
+    bucketTop = (day + 1) * width;
+}
+
+void CalendarEventQueue::insert(const Event& event) {
+    Bucket& bucket = buckets[bucketIndex(event.getTime())];
+    
+    // Most events are scheduled after everything already in their bucket,
+    // so the search usually ends at the back
+    auto position = std::upper_bound(bucket.events.begin() + bucket.head, bucket.events.end(),
+                                     event, eventBefore);
+    bucket.events.insert(position, event);
+}
+
+Event CalendarEventQueue::takeFront(std::size_t index) {
+    Bucket& bucket = buckets[index];
+    Event event = bucket.front();
+    bucket.head++;
+    
+    // Reclaim consumed slots once they make up most of the bucket
+    if (bucket.head == bucket.events.size()) {
+        bucket.events.clear();
+        bucket.head = 0;
+    } else if (bucket.head >= 32 && bucket.head * 2 >= bucket.events.size()) {
+        bucket.events.erase(bucket.events.begin(), bucket.events.begin() + bucket.head);
+        bucket.head = 0;
+    }
+    
+    return event;
+}
+
+void CalendarEventQueue::resize(std::size_t newBucketCount) {
+    std::pmr::vector<Event> all(buckets.get_allocator());
+    all.reserve(count);
+    for (Bucket& bucket : buckets) {
+        all.insert(all.end(), bucket.events.begin() + bucket.head, bucket.events.end());
+    }
+    
+    // Estimate the bucket width from the spacing of the earliest events,
+    // ignoring gaps that are far larger than average
+    if (all.size() >= 2) {
+        std::size_t sampleSize = std::min(WIDTH_SAMPLE_SIZE, all.size());
+        std::nth_element(all.begin(), all.begin() + (sampleSize - 1), all.end(), eventBefore);
+        std::sort(all.begin(), all.begin() + sampleSize, eventBefore);
+        
+        long long span = all[sampleSize - 1].getTime() - all[0].getTime();
+        double average = static_cast<double>(span) / (sampleSize - 1);
+        
+        long long trimmedSpan = 0;
+        std::size_t trimmedGaps = 0;
+        for (std::size_t i = 1; i < sampleSize; i++) {
+            long long gap = all[i].getTime() - all[i - 1].getTime();
+            if (gap <= 2 * average) {
+                trimmedSpan += gap;
+                trimmedGaps++;
+            }
+        }
+        
+        double trimmedAverage = trimmedGaps > 0 ? static_cast<double>(trimmedSpan) / trimmedGaps : 0.0;
+        width = std::max(1, static_cast<int>(std::min(3.0 * trimmedAverage, 1e9)));
+    }
+    
+    buckets.assign(newBucketCount, Bucket(buckets.get_allocator()));
+    bucketMask = newBucketCount - 1;
+    for (const Event& event : all) {
+        insert(event);
+    }
+    setCurrent(lastTime);
+}
+
+void CalendarEventQueue::push(const Event& event) {
+    // An event earlier than the current position moves the calendar back
+    if (event.getTime() < lastTime) {
+        setCurrent(event.getTime());
+    }
+    
+    insert(event);
+    count++;
+    
+    if (count > 2 * buckets.size()) {
+        resize(buckets.size() * 2);
+    }
+}
+
+Event CalendarEventQueue::pop() {
+    std::size_t index = lastBucket;
+    long long top = bucketTop;
+    std::size_t found = buckets.size();
+    
+    // Walk the days of the current year looking for an event due in that day
+    for (std::size_t n = 0; n < buckets.size(); n++) {
+        const Bucket& bucket = buckets[index];
+        if (!bucket.empty() && bucket.front().getTime() < top) {
+            found = index;
+            break;
+        }
+        index = (index + 1) & bucketMask;
+        top += width;
+    }
+    
+    if (found != buckets.size()) {
+        lastBucket = found;
+        bucketTop = top;
+        lastTime = buckets[found].front().getTime();
+    } else {
+        // Nothing due this year: jump straight to the earliest event
+        for (std::size_t i = 0; i < buckets.size(); i++) {
+            if (!buckets[i].empty() &&
+                (found == buckets.size() || eventBefore(buckets[i].front(), buckets[found].front()))) {
+                found = i;
+            }
+        }
+        setCurrent(buckets[found].front().getTime());
+    }
+    
+    Event event = takeFront(found);
+    count--;
+    
+    if (buckets.size() > MIN_BUCKETS && count < buckets.size() / 2) {
+        resize(buckets.size() / 2);
+    }
+    
+    return event;
+}
+
+bool CalendarEventQueue::empty() const {
+    return count == 0;
+}
+
+std::size_t CalendarEventQueue::size() const {
+    return count;
+}
+
+void CalendarEventQueue::collect(std::vector<Event>& out) const {
+    for (const Bucket& bucket : buckets) {
+        out.insert(out.end(), bucket.events.begin() + bucket.head, bucket.events.end());
+    }
+}
+
+EventQueue::EventQueue(EventQueueKind kind, std::pmr::memory_resource* memory)
+    : nextSequence(0) {
+    if (kind == EventQueueKind::CALENDAR) {
+        backend.reset(new CalendarEventQueue(memory));
+    } else {
+        backend.reset(new BinaryHeapEventQueue(memory));
+    }
+}
+
 void EventQueue::addEvent(const Event& event) {
-    events.push(event);
+    Event stamped = event;
+    stamped.setSequence(nextSequence++);
+    backend->push(stamped);
 }
 
 bool EventQueue::hasEvents() const {
-    return !events.empty();
+    return !backend->empty();
 }
 
 Event EventQueue::getNextEvent() {
-    Event event = events.top();
-    events.pop();
-    return event;
-}
\ No newline at end of file
+    return backend->pop();
+}
+
+std::size_t EventQueue::size() const {
+    return backend->size();
+}
+
+void EventQueue::save(SnapshotWriter& out) const {
+    std::vector<Event> events;
+    events.reserve(backend->size());
+    backend->collect(events);
+    
+    // Canonically only the pop order matters, not the sequence numbers behind it
+    if (out.isCanonical()) {
+        std::sort(events.begin(), events.end(), eventBefore);
+        out.write<std::uint64_t>(events.size());
+        for (const Event& event : events) {
+            out.write(event.getType());
+            out.write(event.getTime());
+            out.writeHandle(event.getProcess());
+        }
+        return;
+    }
+    
+    out.write(nextSequence);
+    out.write<std::uint64_t>(events.size());
+    for (const Event& event : events) {
+        out.write(event.getType());
+        out.write(event.getTime());
+        out.writeHandle(event.getProcess());
+        out.write(event.getSequence());
+    }
+}
+
+void EventQueue::restore(SnapshotReader& in, std::size_t processCount) {
+    in.expect(backend->empty(), "checkpoint restored into a running simulation");
+    in.read(nextSequence);
+    
+    std::uint64_t count = in.readSize(UINT32_MAX);
+    for (std::uint64_t i = 0; i < count; i++) {
+        EventType type = in.read<EventType>();
+        int time = in.read<int>();
+        ProcessHandle process = in.read<ProcessHandle>();
+        Event event(type, time, process);
+        event.setSequence(in.read<std::uint64_t>());
+        in.expect(type <= EventType::PROCESS_PREEMPTED && process < processCount &&
+                  event.getSequence() < nextSequence,
+                  "corrupt checkpoint");
+        backend->push(event);
+    }
+}
@@ -1,11 +1,18 @@
 #ifndef EVENT_H
 #define EVENT_H
 
-#include <queue>
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
 #include "process.h"
 
-enum class EventType {
+class SnapshotReader;
+class SnapshotWriter;
+
+enum class EventType : std::uint8_t {
     PROCESS_ARRIVAL,
     CPU_BURST_COMPLETION,
     IO_BURST_COMPLETION,
@@ -17,14 +24,17 @@ class Event {
 private:
     EventType type;
     int time;
-    std::shared_ptr<Process> process;
+    ProcessHandle process;
+    std::uint64_t sequence; // Insertion order, assigned by the EventQueue
 
 public:
-    Event(EventType type, int time, std::shared_ptr<Process> process);
+    Event(EventType type, int time, ProcessHandle process);
     
     EventType getType() const;
     int getTime() const;
-    std::shared_ptr<Process> getProcess() const;
+    ProcessHandle getProcess() const;
+    std::uint64_t getSequence() const;
+    void setSequence(std::uint64_t seq);
     
     std::string typeToString() const;
 };
@@ -38,18 +48,123 @@ struct EventComparator {
         }
         
         // For events at the same time, prioritize based on event type
-        return static_cast<int>(e1.getType()) > static_cast<int>(e2.getType());
+        if (e1.getType() != e2.getType()) {
+            return static_cast<int>(e1.getType()) > static_cast<int>(e2.getType());
+        }
+        
+        // Identical time and type: first inserted comes out first, so every
+        // queue backend produces the same order
+        return e1.getSequence() > e2.getSequence();
     }
 };
 
+// Available EventQueue implementations
+enum class EventQueueKind {
+    BINARY_HEAP,
+    CALENDAR
+};
+
+// Parses "heap" or "calendar"; returns false for unknown names
+bool parseEventQueueKind(const std::string& name, EventQueueKind& kind);
+
+// Storage strategy behind EventQueue. Implementations must return events in
+// EventComparator order.
+class EventQueueBackend {
+public:
+    virtual ~EventQueueBackend() = default;
+    
+    virtual void push(const Event& event) = 0;
+    virtual Event pop() = 0;
+    virtual bool empty() const = 0;
+    virtual std::size_t size() const = 0;
+    // Appends every queued event to out, in no particular order
+    virtual void collect(std::vector<Event>& out) const = 0;
+};
+
+// O(log n) binary heap, kept with std::push_heap/pop_heap so that its
+// contents can be saved
+class BinaryHeapEventQueue : public EventQueueBackend {
+private:
+    std::pmr::vector<Event> events;
+
+public:
+    explicit BinaryHeapEventQueue(std::pmr::memory_resource* memory);
+    
+    void push(const Event& event) override;
+    Event pop() override;
+    bool empty() const override;
+    std::size_t size() const override;
+    void collect(std::vector<Event>& out) const override;
+};
+
+// Calendar queue (R. Brown, 1988): events are hashed by time into an array of
+// "day" buckets that together cover one "year". Dequeue walks the days of the
+// current year, so enqueue and dequeue are amortized O(1) when the bucket
+// width matches the event density. The bucket count doubles or halves with
+// the queue size and the width is re-estimated on every resize.
+class CalendarEventQueue : public EventQueueBackend {
+private:
+    // Events in a bucket are kept sorted; consumed events are skipped via head
+    // Buckets are allocator-aware so the bucket array hands its memory
+    // resource down to the events of every bucket
+    struct Bucket {
+        using allocator_type = std::pmr::polymorphic_allocator<Event>;
+        
+        std::pmr::vector<Event> events;
+        std::size_t head;
+        
+        explicit Bucket(const allocator_type& allocator = {}) : events(allocator), head(0) {}
+        Bucket(const Bucket& other, const allocator_type& allocator)
+            : events(other.events, allocator), head(other.head) {}
+        Bucket(Bucket&& other, const allocator_type& allocator)
+            : events(std::move(other.events), allocator), head(other.head) {}
+        bool empty() const { return head == events.size(); }
+        const Event& front() const { return events[head]; }
+    };
+    
+    std::pmr::vector<Bucket> buckets;
+    std::size_t bucketMask;     // Bucket count is a power of two
+    int width;                  // Time span covered by one bucket
+    std::size_t count;
+    std::size_t lastBucket;     // Bucket of the most recently dequeued event
+    long long bucketTop;        // Exclusive upper time bound of lastBucket in the current year
+    int lastTime;               // Time of the most recently dequeued event
+    
+    std::size_t bucketIndex(int time) const;
+    void insert(const Event& event);
+    void setCurrent(int time);
+    Event takeFront(std::size_t bucket);
+    void resize(std::size_t newBucketCount);
+
+public:
+    explicit CalendarEventQueue(std::pmr::memory_resource* memory);
+    
+    void push(const Event& event) override;
+    Event pop() override;
+    bool empty() const override;
+    std::size_t size() const override;
+    void collect(std::vector<Event>& out) const override;
+};
+
 class EventQueue {
 private:
-    std::priority_queue<Event, std::vector<Event>, EventComparator> events;
+    std::unique_ptr<EventQueueBackend> backend;
+    std::uint64_t nextSequence;
 
 public:
+    explicit EventQueue(EventQueueKind kind = EventQueueKind::BINARY_HEAP,
+                        std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    
     void addEvent(const Event& event);
     bool hasEvents() const;
     Event getNextEvent();
+    std::size_t size() const;
+    
+    // Checkpointing. Events keep their sequence numbers, so a restored queue
+    // pops in exactly the same order. restore needs an empty queue and the
+    // size of the restored process table, which every event must refer into.
+    void save(SnapshotWriter& out) const;
+    void restore(SnapshotReader& in, std::size_t processCount);
 };
 
-#endif // EVENT_H
\ No newline at end of file
+#endif // EVENT_H
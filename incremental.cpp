@@ -0,0 +1,313 @@
+#include "incremental.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "arena.h"
+#include "parser.h"
+#include "sweep.h"
+#include "trace.h"
+
+bool parseWorkloadEdit(const std::string& text, WorkloadEdit& edit) {
+    std::size_t colon = text.find(':');
+    std::size_t equals = text.find('=', colon == std::string::npos ? 0 : colon);
+    if (colon == std::string::npos || equals == std::string::npos) {
+        return false;
+    }
+    
+    auto parseInt = [](const std::string& field, int& value) {
+        char* end = nullptr;
+        long parsed = std::strtol(field.c_str(), &end, 10);
+        if (field.empty() || *end != '\0' || parsed < INT32_MIN || parsed > INT32_MAX) {
+            return false;
+        }
+        value = static_cast<int>(parsed);
+        return true;
+    };
+    
+    WorkloadEdit parsed;
+    std::string field = text.substr(colon + 1, equals - colon - 1);
+    if (!parseInt(text.substr(0, colon), parsed.id) || !parseInt(text.substr(equals + 1), parsed.value)) {
+        return false;
+    }
+    
+    if (field == "arrival") {
+        parsed.field = WorkloadEdit::Field::ARRIVAL;
+    } else if (field == "nice") {
+        parsed.field = WorkloadEdit::Field::NICE;
+        if (parsed.value < -20 || parsed.value > 19) {
+            return false;
+        }
+    } else if (field.compare(0, 3, "cpu") == 0 || field.compare(0, 2, "io") == 0) {
+        bool cpu = field[0] == 'c';
+        parsed.field = cpu ? WorkloadEdit::Field::CPU_BURST : WorkloadEdit::Field::IO_BURST;
+        if (!parseInt(field.substr(cpu ? 3 : 2), parsed.burst) || parsed.burst < 0 || parsed.value < 0) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    
+    edit = parsed;
+    return true;
+}
+
+Workload materializeWorkload(const Workload& workload) {
+    if (workload.generated) {
+        throw std::runtime_error("Incremental simulation needs an input workload");
+    }
+    if (!workload.trace && !workload.text) {
+        return workload;
+    }
+    
+    Workload copy;
+    copy.processSwitchTime = workload.processSwitchTime;
+    if (workload.trace) {
+        const BinaryTrace& trace = *workload.trace;
+        std::vector<int> cpuBursts;
+        std::vector<int> ioBursts;
+        copy.processes.reserve(trace.size());
+        for (std::size_t i = 0; i < trace.size(); i++) {
+            decodeBursts(trace.burstRange(i), cpuBursts, ioBursts);
+            copy.processes.add(trace.getId(i), trace.getArrivalTime(i), trace.getNice(i), cpuBursts, ioBursts);
+        }
+        copy.processes.bursts.finish();
+        copy.indexArrivals();
+    } else {
+        copy = parseWorkload(workload.text->data(), workload.text->data() + workload.text->size());
+    }
+    return copy;
+}
+
+Workload applyEdits(const Workload& workload, const std::vector<WorkloadEdit>& edits,
+                    std::vector<std::size_t>& edited) {
+    const ProcessColumns& processes = workload.processes;
+    std::vector<std::vector<const WorkloadEdit*>> editsOf(processes.size());
+    edited.clear();
+    for (const WorkloadEdit& edit : edits) {
+        auto found = std::find(processes.ids.begin(), processes.ids.end(), edit.id);
+        if (found == processes.ids.end()) {
+            throw std::runtime_error("Edit of unknown process " + std::to_string(edit.id));
+        }
+        std::size_t index = static_cast<std::size_t>(found - processes.ids.begin());
+        if (editsOf[index].empty()) {
+            edited.push_back(index);
+        }
+        editsOf[index].push_back(&edit);
+    }
+    
+    // The burst pool is rebuilt as a whole; a process's bursts cannot grow in place
+    Workload copy;
+    copy.processSwitchTime = workload.processSwitchTime;
+    copy.processes.reserve(processes.size());
+    std::vector<int> cpuBursts;
+    std::vector<int> ioBursts;
+    for (std::size_t i = 0; i < processes.size(); i++) {
+        int arrivalTime = processes.arrivalTimes[i];
+        int nice = processes.nices[i];
+        decodeBursts(processes.bursts.range(i), cpuBursts, ioBursts);
+        
+        for (const WorkloadEdit* edit : editsOf[i]) {
+            std::vector<int>& bursts = edit->field == WorkloadEdit::Field::IO_BURST ? ioBursts : cpuBursts;
+            switch (edit->field) {
+                case WorkloadEdit::Field::ARRIVAL:
+                    arrivalTime = edit->value;
+                    break;
+                case WorkloadEdit::Field::NICE:
+                    nice = edit->value;
+                    break;
+                case WorkloadEdit::Field::CPU_BURST:
+                case WorkloadEdit::Field::IO_BURST:
+                    if (static_cast<std::size_t>(edit->burst) >= bursts.size()) {
+                        throw std::runtime_error("Process " + std::to_string(edit->id) + " has no burst " +
+                                                 std::to_string(edit->burst) + " to edit");
+                    }
+                    bursts[edit->burst] = edit->value;
+                    break;
+            }
+        }
+        copy.processes.add(processes.ids[i], arrivalTime, nice, cpuBursts, ioBursts);
+    }
+    copy.processes.bursts.finish();
+    copy.indexArrivals();
+    return copy;
+}
+
+namespace {
+
+// Position of the process at input position index in the arrival order
+std::size_t arrivalPosition(const Workload& workload, std::size_t index) {
+    if (workload.arrivalOrder.empty()) {
+        return index;
+    }
+    
+    // The order is a stable sort by arrival time: by (arrival time, input position)
+    const std::vector<int>& arrivalTimes = workload.processes.arrivalTimes;
+    auto position = std::lower_bound(workload.arrivalOrder.begin(), workload.arrivalOrder.end(), index,
+                                     [&](std::uint32_t other, std::size_t target) {
+                                         if (arrivalTimes[other] != arrivalTimes[target]) {
+                                             return arrivalTimes[other] < arrivalTimes[target];
+                                         }
+                                         return other < target;
+                                     });
+    return static_cast<std::size_t>(position - workload.arrivalOrder.begin());
+}
+
+} // namespace
+
+void IncrementalReport::print() const {
+    std::cout << "Re-simulated " << events << " of " << baselineEvents << " events from time "
+              << resumeTime;
+    if (converged) {
+        std::cout << ", converged with the baseline at time " << convergeTime << "\n";
+    } else {
+        std::cout << ", did not converge with the baseline\n";
+    }
+}
+
+IncrementalSimulation::IncrementalSimulation(const std::string& algorithm, const Workload& input,
+                                             const SimulationOptions& runOptions, int interval)
+    : algorithm(algorithm), workload(materializeWorkload(input)), options(runOptions),
+      detailedMode(runOptions.detailedMode), baselineEvents(0) {
+    // Per-process records are rebuilt from the outcome log instead of being
+    // copied into every snapshot
+    options.detailedMode = false;
+    options.verboseMode = false;
+    options.checkpointInterval = interval;
+    options.restoreFile.clear();
+    
+    SimulationArena arena;
+    std::ostringstream unusedTrace;
+    visitSimulation(algorithm, workload, options, unusedTrace, arena.resource(),
+                    [&](auto& simulator, ArrivalSource& arrivals) {
+        simulator.setOutcomeLog(&outcomes);
+        simulator.setCheckpointHandler([&](long long due) {
+            Snapshot snapshot;
+            snapshot.due = due;
+            snapshot.time = simulator.getCurrentTime();
+            snapshot.admitted = arrivals.admittedCount();
+            snapshot.events = simulator.getEventCount();
+            snapshot.outcomes = outcomes.size();
+            snapshot.totals = simulator.getRunningStatistics().getTotals();
+            
+            std::ostringstream checkpoint;
+            simulator.saveCheckpoint(checkpoint);
+            snapshot.checkpoint = checkpoint.str();
+            std::ostringstream state;
+            simulator.saveCanonicalState(state);
+            snapshot.state = state.str();
+            
+            snapshots.push_back(std::move(snapshot));
+            return true;
+        });
+        
+        simulator.run();
+        baseline = simulator.getStatistics();
+        baselineEvents = simulator.getEventCount();
+    });
+}
+
+void IncrementalSimulation::addRecords(Statistics& stats, const std::vector<ProcessOutcome>& log,
+                                       std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; i++) {
+        stats.addRecord(log[i].record);
+    }
+}
+
+Statistics IncrementalSimulation::getBaseline() const {
+    Statistics result = baseline;
+    if (detailedMode) {
+        result.setRecordProcesses(true);
+        addRecords(result, outcomes, 0, outcomes.size());
+        result.sortProcesses();
+    }
+    return result;
+}
+
+Statistics IncrementalSimulation::rerun(const std::vector<WorkloadEdit>& edits,
+                                        IncrementalReport& report) const {
+    std::vector<std::size_t> edited;
+    Workload changed = applyEdits(workload, edits, edited);
+    
+    // Arrival positions touched by the edits, in either workload
+    std::size_t firstAffected = SIZE_MAX;
+    std::size_t lastAffected = 0;
+    for (std::size_t index : edited) {
+        std::size_t before = arrivalPosition(workload, index);
+        std::size_t after = arrivalPosition(changed, index);
+        firstAffected = std::min(firstAffected, std::min(before, after));
+        lastAffected = std::max(lastAffected, std::max(before, after));
+    }
+    
+    // Resume from the last snapshot that has none of the edited processes
+    // admitted yet; admissions only grow, so the snapshots are sorted by it
+    auto next = std::upper_bound(snapshots.begin(), snapshots.end(), firstAffected,
+                                 [](std::size_t affected, const Snapshot& snapshot) {
+                                     return affected < snapshot.admitted;
+                                 });
+    const Snapshot* resume = next == snapshots.begin() ? nullptr : &*(next - 1);
+    const Snapshot* converged = nullptr;
+    
+    report = IncrementalReport();
+    report.resumeTime = resume ? resume->time : 0;
+    report.baselineEvents = baselineEvents;
+    
+    std::vector<ProcessOutcome> editedOutcomes;
+    SimulationArena arena;
+    std::ostringstream unusedTrace;
+    Statistics result = visitSimulation(algorithm, changed, options, unusedTrace, arena.resource(),
+                                        [&](auto& simulator, ArrivalSource& arrivals) {
+        if (resume) {
+            std::istringstream checkpoint(resume->checkpoint);
+            simulator.restoreCheckpoint(checkpoint);
+        }
+        simulator.setOutcomeLog(&editedOutcomes);
+        
+        // Stop at the first snapshot where the edited run is back in the baseline's state
+        simulator.setCheckpointHandler([&](long long due) {
+            while (next != snapshots.end() && next->due < due) {
+                ++next;
+            }
+            std::uint64_t admitted = arrivals.admittedCount();
+            if (next == snapshots.end() || next->due != due || next->time != simulator.getCurrentTime() ||
+                next->admitted != admitted || admitted <= lastAffected) {
+                return true;
+            }
+            
+            std::ostringstream state;
+            simulator.saveCanonicalState(state);
+            if (state.str() != next->state) {
+                return true;
+            }
+            converged = &*next;
+            return false;
+        });
+        
+        simulator.run();
+        report.events = simulator.getEventCount() - (resume ? resume->events : 0);
+        return simulator.getStatistics();
+    });
+    
+    // The rest of the run is the baseline's
+    if (converged) {
+        report.converged = true;
+        report.convergeTime = converged->time;
+        for (std::size_t i = converged->outcomes; i < outcomes.size(); i++) {
+            result.addOutcome(outcomes[i]);
+        }
+        result.addTotals(converged->totals, baseline.getTotals());
+        result.setTotalTime(baseline.getTotalTime());
+    }
+    
+    if (detailedMode) {
+        result.setRecordProcesses(true);
+        addRecords(result, outcomes, 0, resume ? resume->outcomes : 0);
+        addRecords(result, editedOutcomes, 0, editedOutcomes.size());
+        if (converged) {
+            addRecords(result, outcomes, converged->outcomes, outcomes.size());
+        }
+        result.sortProcesses();
+    }
+    return result;
+}
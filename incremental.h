@@ -0,0 +1,103 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "simulator.h"
+#include "statistics.h"
+#include "workload.h"
+
+// One change to a single process, written "<id>:<field>=<value>" where field
+// is arrival, nice, cpu<k> or io<k> (bursts counted from 0), e.g. "17:cpu2=40"
+struct WorkloadEdit {
+    enum class Field {
+        ARRIVAL,
+        NICE,
+        CPU_BURST,
+        IO_BURST
+    };
+    
+    int id;
+    Field field;
+    int burst;
+    int value;
+    
+    WorkloadEdit() : id(0), field(Field::ARRIVAL), burst(0), value(0) {}
+};
+
+// Parses "<id>:<field>=<value>"; returns false if malformed
+bool parseWorkloadEdit(const std::string& text, WorkloadEdit& edit);
+
+// Copies parsed, streamed or trace input into process columns. Throws
+// std::runtime_error for generated workloads.
+Workload materializeWorkload(const Workload& workload);
+
+// Copy of an in-memory workload with the edits applied; edited receives the
+// input positions of the processes changed. Throws std::runtime_error if an
+// edit names an unknown process or burst.
+Workload applyEdits(const Workload& workload, const std::vector<WorkloadEdit>& edits,
+                    std::vector<std::size_t>& edited);
+
+// How much of the run an edit had to simulate again
+struct IncrementalReport {
+    int resumeTime;             // Time of the snapshot the edited run started from
+    bool converged;             // The edited run caught up with the baseline
+    int convergeTime;           // Time at which it did
+    std::uint64_t events;       // Events simulated for the edit
+    std::uint64_t baselineEvents;
+    
+    IncrementalReport() : resumeTime(0), converged(false), convergeTime(0), events(0), baselineEvents(0) {}
+    
+    void print() const;
+};
+
+// A baseline run of one algorithm that keeps a snapshot of its state every
+// interval time units, so that edited versions of the workload are simulated
+// only where they differ. An edited run restores the last snapshot taken
+// before the first edited process was admitted and stops at the first later
+// snapshot whose state matches the baseline again (compared canonically, see
+// SnapshotWriter) once every edited process has been admitted. From there on
+// both runs are identical, so the rest of the result is taken from the
+// baseline's log of per-process outcomes, in the same order, which makes it
+// identical to a full run of the edited workload.
+class IncrementalSimulation {
+private:
+    struct Snapshot {
+        long long due;              // Checkpoint time it was taken for
+        int time;
+        std::uint64_t admitted;     // Processes admitted so far
+        std::uint64_t events;
+        std::size_t outcomes;       // Length of the outcome log at this point
+        StatisticsTotals totals;
+        std::string checkpoint;     // For restoring
+        std::string state;          // Canonical, for comparing
+    };
+    
+    std::string algorithm;
+    Workload workload;
+    SimulationOptions options;
+    bool detailedMode;
+    std::vector<Snapshot> snapshots;
+    std::vector<ProcessOutcome> outcomes;
+    Statistics baseline;
+    std::uint64_t baselineEvents;
+    
+    // Adds the records of outcomes [begin, end) to stats
+    static void addRecords(Statistics& stats, const std::vector<ProcessOutcome>& log,
+                           std::size_t begin, std::size_t end);
+
+public:
+    // Runs the baseline; interval must be positive
+    IncrementalSimulation(const std::string& algorithm, const Workload& workload,
+                          const SimulationOptions& options, int interval);
+    
+    Statistics getBaseline() const;
+    std::size_t getSnapshotCount() const { return snapshots.size(); }
+    
+    // Result of the workload with edits applied
+    Statistics rerun(const std::vector<WorkloadEdit>& edits, IncrementalReport& report) const;
+};
+
+#endif // INCREMENTAL_H
@@ -0,0 +1,203 @@
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include "process.h"
+#include "snapshot.h"
+
+// Min-heap of process handles with 4 children per node. A position index per
+// handle allows changing the key of, or removing, any queued process in
+// O(log n). Equal keys come out in insertion order (FIFO). Handles are
+// ProcessTable slots, so the index is a dense vector rather than a map.
+template <typename Key>
+class IndexedHeap {
+private:
+    static constexpr std::size_t ARITY = 4;
+    static constexpr std::uint32_t NOT_QUEUED = UINT32_MAX;
+    
+    struct Entry {
+        Key key;
+        std::uint64_t sequence;     // Insertion order, breaks key ties
+        ProcessHandle process;
+    };
+    
+    std::pmr::vector<Entry> entries;
+    std::pmr::vector<std::uint32_t> positions;  // Heap index of each handle
+    std::uint64_t nextSequence;
+    
+    static bool before(const Entry& a, const Entry& b) {
+        if (a.key != b.key) {
+            return a.key < b.key;
+        }
+        return a.sequence < b.sequence;
+    }
+    
+    void place(std::size_t index, const Entry& entry) {
+        entries[index] = entry;
+        positions[entry.process] = static_cast<std::uint32_t>(index);
+    }
+    
+    void siftUp(std::size_t index) {
+        Entry entry = entries[index];
+        while (index > 0) {
+            std::size_t parent = (index - 1) / ARITY;
+            if (!before(entry, entries[parent])) {
+                break;
+            }
+            place(index, entries[parent]);
+            index = parent;
+        }
+        place(index, entry);
+    }
+    
+    void siftDown(std::size_t index) {
+        Entry entry = entries[index];
+        std::size_t count = entries.size();
+        while (true) {
+            std::size_t first = index * ARITY + 1;
+            if (first >= count) {
+                break;
+            }
+            
+            std::size_t best = first;
+            std::size_t last = first + ARITY < count ? first + ARITY : count;
+            for (std::size_t child = first + 1; child < last; child++) {
+                if (before(entries[child], entries[best])) {
+                    best = child;
+                }
+            }
+            if (!before(entries[best], entry)) {
+                break;
+            }
+            place(index, entries[best]);
+            index = best;
+        }
+        place(index, entry);
+    }
+    
+    // Removes the entry at a heap index and restores the heap property
+    void erase(std::size_t index) {
+        positions[entries[index].process] = NOT_QUEUED;
+        Entry last = entries.back();
+        entries.pop_back();
+        if (index == entries.size()) {
+            return;
+        }
+        
+        entries[index] = last;
+        positions[last.process] = static_cast<std::uint32_t>(index);
+        if (index > 0 && before(last, entries[(index - 1) / ARITY])) {
+            siftUp(index);
+        } else {
+            siftDown(index);
+        }
+    }
+
+public:
+    explicit IndexedHeap(std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : entries(memory), positions(memory), nextSequence(0) {}
+    
+    bool empty() const { return entries.empty(); }
+    std::size_t size() const { return entries.size(); }
+    
+    bool contains(ProcessHandle process) const {
+        return process < positions.size() && positions[process] != NOT_QUEUED;
+    }
+    
+    // Queues a process that is not already queued
+    void push(ProcessHandle process, Key key) {
+        if (process >= positions.size()) {
+            positions.resize(static_cast<std::size_t>(process) + 1, NOT_QUEUED);
+        }
+        entries.push_back(Entry{key, nextSequence++, process});
+        siftUp(entries.size() - 1);
+    }
+    
+    // Key of a queued process
+    Key keyOf(ProcessHandle process) const { return entries[positions[process]].key; }
+    
+    // Process with the smallest key; the heap must not be empty
+    ProcessHandle top() const { return entries.front().process; }
+    Key topKey() const { return entries.front().key; }
+    
+    ProcessHandle pop() {
+        ProcessHandle process = entries.front().process;
+        erase(0);
+        return process;
+    }
+    
+    // Removes a queued process; returns false if it was not queued
+    bool remove(ProcessHandle process) {
+        if (!contains(process)) {
+            return false;
+        }
+        erase(positions[process]);
+        return true;
+    }
+    
+    // Changes the key of a queued process in place. The process keeps its
+    // place among equal keys.
+    void updateKey(ProcessHandle process, Key key) {
+        std::size_t index = positions[process];
+        Key oldKey = entries[index].key;
+        entries[index].key = key;
+        if (key < oldKey) {
+            siftUp(index);
+        } else if (oldKey < key) {
+            siftDown(index);
+        }
+    }
+    
+    void decreaseKey(ProcessHandle process, Key key) {
+        std::size_t index = positions[process];
+        entries[index].key = key;
+        siftUp(index);
+    }
+    
+    // Saves the heap layout as is, so a restored heap pops in the same order;
+    // canonically the entries are written in pop order instead
+    void save(SnapshotWriter& out) const {
+        if (out.isCanonical()) {
+            std::pmr::vector<Entry> sorted(entries);
+            std::sort(sorted.begin(), sorted.end(), before);
+            out.write<std::uint64_t>(sorted.size());
+            for (const Entry& entry : sorted) {
+                out.write(entry.key);
+                out.writeHandle(entry.process);
+            }
+            return;
+        }
+        
+        out.write(nextSequence);
+        out.write<std::uint64_t>(entries.size());
+        for (const Entry& entry : entries) {
+            out.write(entry.key);
+            out.write(entry.sequence);
+            out.writeHandle(entry.process);
+        }
+    }
+    
+    // Replaces the contents; every restored handle must be below processCount
+    void restore(SnapshotReader& in, std::size_t processCount) {
+        in.read(nextSequence);
+        std::size_t count = static_cast<std::size_t>(in.readSize(processCount));
+        entries.clear();
+        positions.assign(processCount, NOT_QUEUED);
+        for (std::size_t index = 0; index < count; index++) {
+            Entry entry;
+            in.read(entry.key);
+            in.read(entry.sequence);
+            in.read(entry.process);
+            in.expect(entry.process < processCount && positions[entry.process] == NOT_QUEUED,
+                      "corrupt checkpoint");
+            entries.push_back(entry);
+            positions[entry.process] = static_cast<std::uint32_t>(index);
+        }
+    }
+};
+
+#endif // INDEXED_HEAP_H
@@ -0,0 +1,112 @@
+#include "instrumentation.h"
+
+#ifdef SIM_INSTRUMENT
+
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+const char* const EVENT_NAMES[] = {
+    "PROCESS_ARRIVAL", "CPU_BURST_COMPLETION", "IO_BURST_COMPLETION",
+    "TIME_SLICE_EXPIRED", "PROCESS_PREEMPTED"
+};
+
+const char* const HANDLER_NAMES[] = {
+    "handleProcessArrival", "handleCpuBurstCompletion", "handleIoBurstCompletion",
+    "handleTimeSliceExpired", "handleProcessPreempted"
+};
+
+const char* const SCHEDULER_CALL_NAMES[] = {
+    "addProcess", "getNextProcess", "hasProcesses", "getReadyCount",
+    "shouldPreempt", "getTimeSlice"
+};
+
+void writeHistogram(std::ostream& out, const Histogram& histogram) {
+    out << "{\"samples\": " << histogram.count()
+        << ", \"p50\": " << histogram.valueAtPercentile(50)
+        << ", \"p99\": " << histogram.valueAtPercentile(99)
+        << ", \"max\": " << histogram.max() << ", \"buckets\": [";
+    bool first = true;
+    histogram.forEachBucket([&](std::uint64_t value, std::uint64_t count) {
+        out << (first ? "" : ", ") << "[" << value << ", " << count << "]";
+        first = false;
+    });
+    out << "]}";
+}
+
+void writeString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+Instrumentation::Instrumentation()
+    : eventCounts(), schedulerCalls(), handlerTicks() {
+}
+
+void Instrumentation::countEvent(EventType type, std::size_t eventQueueDepth,
+                                 std::size_t readyQueueDepth) {
+    eventCounts[static_cast<std::size_t>(type)]++;
+    eventQueueDepths.add(eventQueueDepth);
+    readyQueueDepths.add(readyQueueDepth);
+}
+
+std::uint64_t Instrumentation::readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+const char* Instrumentation::tickUnit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "tsc";
+#else
+    return "ns";
+#endif
+}
+
+void Instrumentation::writeJson(std::ostream& out, const std::string& algorithm) const {
+    out << "{\"algorithm\": ";
+    writeString(out, algorithm);
+    
+    out << ", \"events\": {";
+    for (std::size_t i = 0; i < EVENT_TYPES; i++) {
+        out << (i ? ", " : "") << "\"" << EVENT_NAMES[i] << "\": " << eventCounts[i];
+    }
+    out << "}, \"event_queue_depth\": ";
+    writeHistogram(out, eventQueueDepths);
+    out << ", \"ready_queue_depth\": ";
+    writeHistogram(out, readyQueueDepths);
+    
+    out << ", \"scheduler_calls\": {";
+    for (std::size_t i = 0; i < SCHEDULER_CALLS; i++) {
+        out << (i ? ", " : "") << "\"" << SCHEDULER_CALL_NAMES[i] << "\": " << schedulerCalls[i];
+    }
+    out << "}";
+    
+#ifdef SIM_INSTRUMENT_TIMING
+    out << ", \"tick_unit\": \"" << tickUnit() << "\", \"handlers\": {";
+    for (std::size_t i = 0; i < EVENT_TYPES; i++) {
+        double mean = eventCounts[i] ? static_cast<double>(handlerTicks[i]) / eventCounts[i] : 0.0;
+        out << (i ? ", " : "") << "\"" << HANDLER_NAMES[i] << "\": {\"calls\": " << eventCounts[i]
+            << ", \"ticks\": " << handlerTicks[i] << ", \"mean_ticks\": " << mean << "}";
+    }
+    out << "}";
+#endif
+    out << "}";
+}
+
+#endif // SIM_INSTRUMENT
@@ -0,0 +1,89 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+// Hot-path counters for the event loop. Everything in this header is compiled
+// only when SIM_INSTRUMENT is defined (make INSTRUMENT=1); otherwise the SIM_*
+// macros expand to nothing and the default build pays no cost. Handler timing
+// additionally needs SIM_INSTRUMENT_TIMING (make INSTRUMENT=timing).
+
+#ifdef SIM_INSTRUMENT
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "distribution.h"
+#include "event.h"
+
+enum class SchedulerCall : std::uint8_t {
+    ADD_PROCESS,
+    GET_NEXT_PROCESS,
+    HAS_PROCESSES,
+    GET_READY_COUNT,
+    SHOULD_PREEMPT,
+    GET_TIME_SLICE
+};
+
+class Instrumentation {
+private:
+    static constexpr std::size_t EVENT_TYPES = 5;
+    static constexpr std::size_t SCHEDULER_CALLS = 6;
+    
+    std::uint64_t eventCounts[EVENT_TYPES];
+    Histogram eventQueueDepths;     // Pending events when each event is processed
+    Histogram readyQueueDepths;     // Ready processes over all cores, same sampling
+    std::uint64_t schedulerCalls[SCHEDULER_CALLS];
+    std::uint64_t handlerTicks[EVENT_TYPES];
+    
+public:
+    Instrumentation();
+    
+    void countEvent(EventType type, std::size_t eventQueueDepth, std::size_t readyQueueDepth);
+    void countSchedulerCall(SchedulerCall call) {
+        schedulerCalls[static_cast<std::size_t>(call)]++;
+    }
+    void addHandlerTicks(EventType type, std::uint64_t ticks) {
+        handlerTicks[static_cast<std::size_t>(type)] += ticks;
+    }
+    
+    // Time stamp counter where available, nanoseconds otherwise
+    static std::uint64_t readTicks();
+    static const char* tickUnit();
+    
+    // Writes one JSON object describing the run
+    void writeJson(std::ostream& out, const std::string& algorithm) const;
+};
+
+// Charges the lifetime of the timer to the handler of an event type
+class HandlerTimer {
+private:
+    Instrumentation& instrumentation;
+    EventType type;
+    std::uint64_t start;
+    
+public:
+    HandlerTimer(Instrumentation& instrumentation, EventType type)
+        : instrumentation(instrumentation), type(type), start(Instrumentation::readTicks()) {}
+    ~HandlerTimer() { instrumentation.addHandlerTicks(type, Instrumentation::readTicks() - start); }
+};
+
+#define SIM_COUNT_EVENT(instrumentation, type, eventQueueDepth, readyQueueDepth) \
+    (instrumentation).countEvent((type), (eventQueueDepth), (readyQueueDepth))
+#define SIM_COUNT_SCHEDULER_CALL(instrumentation, call) \
+    (instrumentation).countSchedulerCall(SchedulerCall::call)
+
+#ifdef SIM_INSTRUMENT_TIMING
+#define SIM_TIME_HANDLER(instrumentation, type) HandlerTimer handlerTimer((instrumentation), (type))
+#else
+#define SIM_TIME_HANDLER(instrumentation, type) ((void)0)
+#endif
+
+#else
+
+#define SIM_COUNT_EVENT(instrumentation, type, eventQueueDepth, readyQueueDepth) ((void)0)
+#define SIM_COUNT_SCHEDULER_CALL(instrumentation, call) ((void)0)
+#define SIM_TIME_HANDLER(instrumentation, type) ((void)0)
+
+#endif // SIM_INSTRUMENT
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,221 @@
+#include "io_device.h"
+#include <algorithm>
+#include <cstdlib>
+#include "snapshot.h"
+
+std::string ioDisciplineName(IoDiscipline discipline) {
+    switch (discipline) {
+        case IoDiscipline::FIFO: return "FIFO";
+        case IoDiscipline::SSTF: return "SSTF";
+        case IoDiscipline::SCAN: return "SCAN";
+        case IoDiscipline::FAIR: return "FAIR";
+        default: return "UNKNOWN";
+    }
+}
+
+bool parseIoDevices(const std::string& text, std::vector<IoDeviceSettings>& devices) {
+    std::vector<IoDeviceSettings> parsed;
+    std::size_t start = 0;
+    
+    for (;;) {
+        std::size_t comma = text.find(',', start);
+        std::string field = text.substr(start, comma == std::string::npos ? std::string::npos
+                                                                         : comma - start);
+        std::size_t colon = field.find(':');
+        std::string capacity = field.substr(0, colon);
+        std::string discipline = colon == std::string::npos ? "fifo" : field.substr(colon + 1);
+        
+        IoDeviceSettings settings;
+        char* end = nullptr;
+        long value = std::strtol(capacity.c_str(), &end, 10);
+        if (capacity.empty() || *end != '\0' || value <= 0 || value > UINT16_MAX) {
+            return false;
+        }
+        settings.capacity = static_cast<int>(value);
+        
+        if (discipline == "fifo") {
+            settings.discipline = IoDiscipline::FIFO;
+        } else if (discipline == "sstf") {
+            settings.discipline = IoDiscipline::SSTF;
+        } else if (discipline == "scan" || discipline == "elevator") {
+            settings.discipline = IoDiscipline::SCAN;
+        } else if (discipline == "fair") {
+            settings.discipline = IoDiscipline::FAIR;
+        } else {
+            return false;
+        }
+        parsed.push_back(settings);
+        
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    
+    devices = parsed;
+    return true;
+}
+
+int ioTrack(int id, int burst) {
+    // 64-bit finaliser of MurmurHash3 over (id, burst)
+    std::uint64_t x = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(id)) << 32)
+                    | static_cast<std::uint32_t>(burst);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return static_cast<int>(x % IO_TRACKS);
+}
+
+// Blocked set
+void BlockedSet::insert(ProcessHandle process) {
+    if (process >= positions.size()) {
+        positions.resize(process + 1, NOT_BLOCKED);
+    }
+    positions[process] = static_cast<std::uint32_t>(members.size());
+    members.push_back(process);
+}
+
+void BlockedSet::erase(ProcessHandle process) {
+    // The last member takes the place of the erased one
+    std::uint32_t position = positions[process];
+    ProcessHandle last = members.back();
+    members[position] = last;
+    positions[last] = position;
+    members.pop_back();
+    positions[process] = NOT_BLOCKED;
+}
+
+void BlockedSet::save(SnapshotWriter& out) const {
+    // The member order only reflects the order of past erasures
+    if (out.isCanonical()) {
+        const CanonicalHandles& canonical = out.getCanonicalHandles();
+        std::vector<std::uint64_t> keys;
+        keys.reserve(members.size());
+        for (ProcessHandle process : members) {
+            keys.push_back(canonical.keys[process]);
+        }
+        std::sort(keys.begin(), keys.end());
+        out.writeVector(keys);
+        return;
+    }
+    out.writeVector(members);
+}
+
+void BlockedSet::restore(SnapshotReader& in, std::size_t processCount) {
+    in.readVector(members);
+    positions.assign(processCount, NOT_BLOCKED);
+    for (std::size_t i = 0; i < members.size(); i++) {
+        in.expect(members[i] < processCount && positions[members[i]] == NOT_BLOCKED, "corrupt checkpoint");
+        positions[members[i]] = static_cast<std::uint32_t>(i);
+    }
+}
+
+// I/O device
+IoDevice::IoDevice(const IoDeviceSettings& settings, std::pmr::memory_resource* memory)
+    : discipline(settings.discipline), capacity(settings.capacity), busy(0), head(0),
+      sweepingUp(true), waiting(memory), nextSequence(0) {
+}
+
+std::pmr::map<IoDevice::Key, IoDevice::Request>::iterator IoDevice::firstAtOrAbove(int track) {
+    return waiting.lower_bound(Key{track, 0});
+}
+
+std::pmr::map<IoDevice::Key, IoDevice::Request>::iterator IoDevice::firstBelow(long long track) {
+    auto below = waiting.lower_bound(Key{track, 0});
+    if (below == waiting.begin()) {
+        return waiting.end();
+    }
+    
+    // Earliest submitted request on the nearest lower track
+    --below;
+    return waiting.lower_bound(Key{below->first.key, 0});
+}
+
+void IoDevice::start(const Request& request) {
+    busy++;
+    head = request.track;
+}
+
+void IoDevice::finish() {
+    busy--;
+}
+
+void IoDevice::enqueue(const Request& request, int ioTime) {
+    long long key = 0;
+    if (discipline == IoDiscipline::SSTF || discipline == IoDiscipline::SCAN) {
+        key = request.track;
+    } else if (discipline == IoDiscipline::FAIR) {
+        key = ioTime;
+    }
+    waiting.emplace(Key{key, nextSequence++}, request);
+}
+
+IoDevice::Request IoDevice::takeNext() {
+    auto next = waiting.begin();
+    if (discipline == IoDiscipline::SSTF) {
+        // Nearest track on either side; ties go up
+        auto above = firstAtOrAbove(head);
+        auto below = firstBelow(head);
+        next = above;
+        if (below != waiting.end() &&
+            (above == waiting.end() || head - below->first.key < above->first.key - head)) {
+            next = below;
+        }
+    } else if (discipline == IoDiscipline::SCAN) {
+        // Keep sweeping while there are requests ahead, otherwise turn around;
+        // requests on the head's own track are served in either direction
+        next = sweepingUp ? firstAtOrAbove(head) : firstAtOrBelow(head);
+        if (next == waiting.end()) {
+            sweepingUp = !sweepingUp;
+            next = sweepingUp ? firstAtOrAbove(head) : firstAtOrBelow(head);
+        }
+    }
+    
+    Request request = next->second;
+    waiting.erase(next);
+    return request;
+}
+
+void IoDevice::save(SnapshotWriter& out) const {
+    bool canonical = out.isCanonical();
+    out.write(busy);
+    out.write(head);
+    out.write(sweepingUp);
+    if (!canonical) {
+        out.write(nextSequence);
+    }
+    out.write<std::uint64_t>(waiting.size());
+    for (const auto& entry : waiting) {
+        out.write(entry.first.key);
+        if (!canonical) {
+            out.write(entry.first.sequence);
+        }
+        out.writeHandle(entry.second.process);
+        out.write(entry.second.track);
+        out.write(entry.second.submitTime);
+    }
+}
+
+void IoDevice::restore(SnapshotReader& in, std::size_t processCount) {
+    in.read(busy);
+    in.read(head);
+    in.read(sweepingUp);
+    in.read(nextSequence);
+    in.expect(busy >= 0 && busy <= capacity && head >= 0 && head < IO_TRACKS, "corrupt checkpoint");
+    
+    std::size_t count = static_cast<std::size_t>(in.readSize(processCount));
+    waiting.clear();
+    for (std::size_t i = 0; i < count; i++) {
+        Key key;
+        Request request;
+        in.read(key.key);
+        in.read(key.sequence);
+        in.read(request.process);
+        in.read(request.track);
+        in.read(request.submitTime);
+        in.expect(request.process < processCount, "corrupt checkpoint");
+        waiting.emplace_hint(waiting.end(), key, request);
+    }
+}
@@ -0,0 +1,131 @@
+#ifndef IO_DEVICE_H
+#define IO_DEVICE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "process.h"
+
+class SnapshotReader;
+class SnapshotWriter;
+
+// Order in which an I/O device serves its waiting requests
+enum class IoDiscipline : std::uint8_t {
+    FIFO,   // In order of submission
+    SSTF,   // Shortest seek time first: the track closest to the head
+    SCAN,   // Elevator: sweep the head up, then down, serving tracks on the way
+    FAIR    // The process that has received the least I/O time so far
+};
+
+std::string ioDisciplineName(IoDiscipline discipline);
+
+// Settings of one I/O device, written "<capacity>[:fifo|sstf|scan|fair]":
+// the number of requests it serves at once and its queueing discipline
+struct IoDeviceSettings {
+    int capacity;
+    IoDiscipline discipline;
+    
+    IoDeviceSettings() : capacity(1), discipline(IoDiscipline::FIFO) {}
+};
+
+// Parses a comma-separated list of device settings, e.g. "1:sstf,2";
+// returns false if malformed
+bool parseIoDevices(const std::string& text, std::vector<IoDeviceSettings>& devices);
+
+// Workloads carry no block addresses, so every I/O burst is given a synthetic
+// track in [0, IO_TRACKS) derived from the process id and burst number. The
+// same burst always lands on the same track, so runs stay reproducible.
+constexpr int IO_TRACKS = 1024;
+int ioTrack(int id, int burst);
+
+// Processes waiting on I/O. Members are kept in a dense array and each
+// handle's position in it in a vector indexed by handle, so insert, erase
+// and membership tests are O(1).
+class BlockedSet {
+private:
+    static constexpr std::uint32_t NOT_BLOCKED = UINT32_MAX;
+    
+    std::pmr::vector<ProcessHandle> members;
+    std::pmr::vector<std::uint32_t> positions;
+    
+public:
+    explicit BlockedSet(std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : members(memory), positions(memory) {}
+    
+    std::size_t size() const { return members.size(); }
+    bool contains(ProcessHandle process) const {
+        return process < positions.size() && positions[process] != NOT_BLOCKED;
+    }
+    void insert(ProcessHandle process);
+    void erase(ProcessHandle process);
+    
+    void save(SnapshotWriter& out) const;
+    void restore(SnapshotReader& in, std::size_t processCount);
+};
+
+// A device with capacity channels, each serving one I/O burst at a time, and
+// a queue of the requests that found every channel busy. The queue is an
+// ordered map keyed by what the discipline serves first (submission order,
+// track or I/O received), so taking the next request is O(log n) for every
+// discipline. With more than one channel the head is where the most recently
+// started request was.
+class IoDevice {
+public:
+    struct Request {
+        ProcessHandle process;
+        int track;
+        int submitTime;
+    };
+    
+private:
+    struct Key {
+        long long key;              // Track for SSTF and SCAN, I/O time for FAIR, 0 for FIFO
+        std::uint64_t sequence;     // Submission order, breaks key ties
+        
+        bool operator<(const Key& other) const {
+            if (key != other.key) {
+                return key < other.key;
+            }
+            return sequence < other.sequence;
+        }
+    };
+    
+    IoDiscipline discipline;
+    int capacity;
+    int busy;           // Channels serving a request
+    int head;           // Track of the last request started
+    bool sweepingUp;    // SCAN direction
+    std::pmr::map<Key, Request> waiting;
+    std::uint64_t nextSequence;
+    
+    // First waiting request on the nearest track at or above / below / at or below track
+    std::pmr::map<Key, Request>::iterator firstAtOrAbove(int track);
+    std::pmr::map<Key, Request>::iterator firstBelow(long long track);
+    std::pmr::map<Key, Request>::iterator firstAtOrBelow(int track) { return firstBelow(track + 1LL); }
+    
+public:
+    IoDevice(const IoDeviceSettings& settings, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    
+    bool isFull() const { return busy >= capacity; }
+    bool hasWaiting() const { return !waiting.empty(); }
+    std::size_t getWaitingCount() const { return waiting.size(); }
+    
+    // Occupies a channel for the request
+    void start(const Request& request);
+    // Frees the channel of a completed request
+    void finish();
+    // Queues a request until a channel frees up; ioTime is the I/O time its
+    // process has received so far, used by FAIR
+    void enqueue(const Request& request, int ioTime);
+    // Removes the request the discipline serves next; must have waiting requests
+    Request takeNext();
+    
+    // Restoring requires a device built with the same settings
+    void save(SnapshotWriter& out) const;
+    void restore(SnapshotReader& in, std::size_t processCount);
+};
+
+#endif // IO_DEVICE_H
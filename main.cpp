@@ -1,31 +1,93 @@
+#include <charconv>
+#include <cstring>
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <vector>
 #include <memory>
-#include <random>
 #include <ctime>
 #include <cstdlib>
 #include <cmath>
+#include <cstdint>
+#include <fstream>
 #include <unistd.h>
+#include "incremental.h"
+#include "parser.h"
 #include "process.h"
+#include "replication.h"
 #include "scheduler.h"
 #include "simulator.h"
+#include "sweep.h"
+#include "trace.h"
+#include "transition_log.h"
+#include "workload.h"
 
 // Function to parse command line arguments
 struct Arguments {
     bool detailedMode;
     bool verboseMode;
+    std::string transitionLogFile;  // Binary verbose log instead of text on stdout
+    std::string timelineFile;       // Chrome Trace Event timeline of the run
+    bool percentiles;       // Print turnaround/wait/response distributions
+    std::string instrumentationFile;    // JSON dump of event loop counters
     std::string algorithm;
+    unsigned numThreads;    // 0 means one per hardware thread
+    EventQueueKind eventQueue;
+    bool streamInput;       // Parse text input lazily instead of loading it
+    int replications;       // Monte Carlo replications of the random workload, 0 for none
+    bool seedGiven;
+    std::uint64_t seed;
+    int numProcesses;       // Size of generated workloads
+    bool sweepQuantum;      // Sweep RR over quantumRange
+    ParameterRange quantumRange;
+    bool sweepSwitchTime;   // Sweep the process switch time over switchTimeRange
+    ParameterRange switchTimeRange;
+    int numCores;
+    int migrationCost;
+    int checkpointInterval; // Simulated time between checkpoints, 0 for none
+    std::string checkpointFile;
+    std::string restoreFile;
+    std::vector<IoDeviceSettings> ioDevices;   // Empty for unlimited parallel I/O
+    bool eventEngineOnly;   // Simulate even runs the analytic fast path could evaluate
+    bool crossCheck;        // Run both and fail if they disagree
+    std::vector<WorkloadEdit> edits;    // Re-simulate incrementally with these applied
     
-    Arguments() : detailedMode(false), verboseMode(false), algorithm("") {}
+    Arguments() : detailedMode(false), verboseMode(false), percentiles(false), algorithm(""), numThreads(0),
+                  eventQueue(EventQueueKind::BINARY_HEAP), streamInput(false), replications(0),
+                  seedGiven(false), seed(0), numProcesses(50), sweepQuantum(false),
+                  sweepSwitchTime(false), numCores(1), migrationCost(0), checkpointInterval(0),
+                  checkpointFile("checkpoint.bin"), eventEngineOnly(false), crossCheck(false) {}
 };
 
+// Prints the usage message and exits
+[[noreturn]] void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [-d] [-v] [-V log_file] [-T timeline.json] [-p] [-a algorithm] [-j threads] "
+              << "[-q heap|calendar] [-S] [-R replications] [-s seed] [-n processes] "
+              << "[-Q quantum_range] [-P switch_time_range] [-c cores] "
+              << "[-m migration_cost] [-I io_devices] [-E] [-X] [-J counters.json] [-C checkpoint_interval] "
+              << "[-K checkpoint_file] [-r restore_file] [-e id:field=value] "
+              << "< input_file\n"
+              << "       " << program << " convert <output_file> < input_file\n"
+              << "       " << program << " decode <log_file>\n";
+    exit(EXIT_FAILURE);
+}
+
+// Reads a count of at least 1 for an option, or exits with the usage message
+int parseCount(const char* program, char option, const char* text) {
+    int value = 0;
+    const char* end = text + std::strlen(text);
+    std::from_chars_result result = std::from_chars(text, end, value);
+    if (result.ec != std::errc() || result.ptr != end || value < 1) {
+        std::cerr << "Invalid value for -" << option << ": " << text << " (expected a positive integer)\n";
+        usage(program);
+    }
+    return value;
+}
+
 Arguments parseArguments(int argc, char* argv[]) {
     Arguments args;
     int opt;
     
-    while ((opt = getopt(argc, argv, "dva:")) != -1) {
+    while ((opt = getopt(argc, argv, "dvV:T:pa:j:q:SR:s:n:Q:P:c:m:I:EXJ:C:K:r:e:")) != -1) {
         switch (opt) {
             case 'd':
                 args.detailedMode = true;
@@ -33,154 +95,196 @@ Arguments parseArguments(int argc, char* argv[]) {
             case 'v':
                 args.verboseMode = true;
                 break;
+            case 'V':
+                args.verboseMode = true;
+                args.transitionLogFile = optarg;
+                break;
+            case 'T':
+                args.timelineFile = optarg;
+                break;
+            case 'p':
+                args.percentiles = true;
+                break;
             case 'a':
                 args.algorithm = optarg;
                 break;
-            default:
-                std::cerr << "Usage: " << argv[0] << " [-d] [-v] [-a algorithm] < input_file\n";
-                exit(EXIT_FAILURE);
-        }
-    }
-    
-    return args;
-}
-
-// Function to parse input file
-struct InputData {
-    int numProcesses;
-    int processSwitchTime;
-    std::vector<std::shared_ptr<Process>> processes;
-};
-
-InputData parseInput() {
-    InputData data;
-    
-    // Read number of processes and process switch time
-    if (!(std::cin >> data.numProcesses >> data.processSwitchTime)) {
-        std::cerr << "Error reading input file\n";
-        exit(EXIT_FAILURE);
-    }
-    
-    // Read process data
-    for (int i = 0; i < data.numProcesses; i++) {
-        int id, arrivalTime, numBursts;
-        
-        if (!(std::cin >> id >> arrivalTime >> numBursts)) {
-            std::cerr << "Error reading process data\n";
-            exit(EXIT_FAILURE);
-        }
-        
-        std::vector<int> cpuBursts;
-        std::vector<int> ioBursts;
-        
-        for (int j = 0; j < numBursts; j++) {
-            int burstNum, cpuTime;
-            
-            if (!(std::cin >> burstNum >> cpuTime)) {
-                std::cerr << "Error reading CPU burst data\n";
-                exit(EXIT_FAILURE);
+            case 'j':
+                args.numThreads = static_cast<unsigned>(parseCount(argv[0], 'j', optarg));
+                break;
+            case 'q':
+                if (!parseEventQueueKind(optarg, args.eventQueue)) {
+                    std::cerr << "Invalid event queue: " << optarg << " (expected heap or calendar)\n";
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'S':
+                args.streamInput = true;
+                break;
+            case 'R':
+                args.replications = parseCount(argv[0], 'R', optarg);
+                break;
+            case 's':
+                args.seedGiven = true;
+                args.seed = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 'n':
+                args.numProcesses = parseCount(argv[0], 'n', optarg);
+                break;
+            case 'Q':
+            case 'P': {
+                ParameterRange& range = opt == 'Q' ? args.quantumRange : args.switchTimeRange;
+                if (!parseParameterRange(optarg, range) || (opt == 'Q' && range.first <= 0) ||
+                    (opt == 'P' && range.first < 0)) {
+                    std::cerr << "Invalid range: " << optarg << " (expected first:last[:step])\n";
+                    exit(EXIT_FAILURE);
+                }
+                (opt == 'Q' ? args.sweepQuantum : args.sweepSwitchTime) = true;
+                break;
             }
-            
-            cpuBursts.push_back(cpuTime);
-            
-            // If this is not the last burst, read I/O time
-            if (j < numBursts - 1) {
-                int ioTime;
-                if (!(std::cin >> ioTime)) {
-                    std::cerr << "Error reading I/O burst data\n";
+            case 'c':
+                args.numCores = std::atoi(optarg);
+                if (args.numCores < 1 || args.numCores > UINT16_MAX) {
+                    std::cerr << "Invalid core count: " << optarg << "\n";
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'm':
+                args.migrationCost = std::atoi(optarg);
+                if (args.migrationCost < 0) {
+                    std::cerr << "Invalid migration cost: " << optarg << "\n";
                     exit(EXIT_FAILURE);
                 }
-                ioBursts.push_back(ioTime);
+                break;
+            case 'I':
+                if (!parseIoDevices(optarg, args.ioDevices)) {
+                    std::cerr << "Invalid I/O devices: " << optarg
+                              << " (expected capacity[:fifo|sstf|scan|fair][,...])\n";
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'E':
+                args.eventEngineOnly = true;
+                break;
+            case 'X':
+                args.crossCheck = true;
+                break;
+            case 'C':
+                args.checkpointInterval = std::atoi(optarg);
+                if (args.checkpointInterval <= 0) {
+                    std::cerr << "Invalid checkpoint interval: " << optarg << "\n";
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'K':
+                args.checkpointFile = optarg;
+                break;
+            case 'r':
+                args.restoreFile = optarg;
+                break;
+            case 'e': {
+                WorkloadEdit edit;
+                if (!parseWorkloadEdit(optarg, edit)) {
+                    std::cerr << "Invalid edit: " << optarg
+                              << " (expected id:field=value, field arrival, nice, cpu<k> or io<k>)\n";
+                    exit(EXIT_FAILURE);
+                }
+                args.edits.push_back(edit);
+                break;
             }
+            case 'J':
+#ifdef SIM_INSTRUMENT
+                args.instrumentationFile = optarg;
+#else
+                std::cerr << "-J needs a build with instrumentation (make INSTRUMENT=1)\n";
+                exit(EXIT_FAILURE);
+#endif
+                break;
+            default:
+                usage(argv[0]);
         }
-        
-        // Create process
-        std::shared_ptr<Process> process = std::make_shared<Process>(
-            id, arrivalTime, cpuBursts, ioBursts);
-        data.processes.push_back(process);
     }
     
-    return data;
+    return args;
 }
 
 // Function to generate random processes
-InputData generateRandomProcesses() {
-    InputData data;
-    data.numProcesses = 50; // Generate 50 processes
+Workload generateRandomProcesses(int numProcesses, std::uint64_t seed) {
+    Workload data;
     data.processSwitchTime = 5; // Process switch overhead time
     
-    // Seed random number generator
-    std::mt19937 rng(static_cast<unsigned>(time(nullptr)));
+    // Processes are generated lazily by each run from the same seed
+    data.generated = true;
+    data.generator.numProcesses = numProcesses;
+    data.generator.seed = seed;
     
-    // Exponential distribution for arrival intervals (mean 50)
-    std::exponential_distribution<double> arrivalDist(1.0 / 50.0);
-    
-    // Uniform distributions for CPU and I/O bursts
-    std::uniform_int_distribution<int> cpuBurstDist(5, 500);
-    std::uniform_int_distribution<int> ioBurstDist(30, 1000);
-    std::uniform_int_distribution<int> numBurstsDist(10, 30); // Average around 20
-    
-    int currentArrivalTime = 0;
+    return data;
+}
+
+// Converts text input on stdin into a binary trace: sim convert <output_file>
+int convertMain(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " convert <output_file> < input_file\n";
+        return EXIT_FAILURE;
+    }
     
-    for (int i = 1; i <= data.numProcesses; i++) {
-        // Generate arrival time based on exponential distribution
-        int arrivalInterval = static_cast<int>(std::ceil(arrivalDist(rng)));
-        currentArrivalTime += arrivalInterval;
-        
-        // Generate number of CPU bursts for this process
-        int numBursts = numBurstsDist(rng);
-        
-        std::vector<int> cpuBursts;
-        std::vector<int> ioBursts;
-        
-        // Generate CPU and I/O bursts
-        for (int j = 0; j < numBursts; j++) {
-            cpuBursts.push_back(cpuBurstDist(rng));
-            
-            // If this is not the last burst, generate I/O time
-            if (j < numBursts - 1) {
-                ioBursts.push_back(ioBurstDist(rng));
-            }
+    try {
+        Workload data = loadWorkload(STDIN_FILENO);
+        if (data.trace) {
+            std::cerr << "Input is already a binary trace\n";
+            return EXIT_FAILURE;
         }
-        
-        // Create process
-        std::shared_ptr<Process> process = std::make_shared<Process>(
-            i, currentArrivalTime, cpuBursts, ioBursts);
-        data.processes.push_back(process);
+        writeTrace(data, argv[2]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
     }
     
-    return data;
+    return EXIT_SUCCESS;
 }
 
-// Function to run simulation for a specific algorithm
-Statistics runSimulation(const std::string& algorithm, const InputData& data, 
-                        bool verboseMode, bool detailedMode) {
-    std::shared_ptr<Scheduler> scheduler = createScheduler(algorithm, data.processSwitchTime);
-    Simulator simulator(verboseMode, detailedMode, scheduler);
-    
-    // Add processes to simulator
-    for (const auto& process : data.processes) {
-        simulator.addProcess(process);
+// Prints a binary transition log written with -V as text: sim decode <log_file>
+int decodeMain(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " decode <log_file>\n";
+        return EXIT_FAILURE;
     }
     
-    // Run simulation
-    simulator.run();
+    try {
+        printTransitionLog(argv[2], std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
     
-    return simulator.getStatistics();
+    return EXIT_SUCCESS;
 }
 
 int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "convert") {
+        return convertMain(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "decode") {
+        return decodeMain(argc, argv);
+    }
+    
     // Parse command line arguments
     Arguments args = parseArguments(argc, argv);
     
+    std::uint64_t seed = args.seedGiven ? args.seed : static_cast<std::uint64_t>(time(nullptr));
+    
     // Parse input or generate random processes
-    InputData data;
-    if (!isatty(STDIN_FILENO)) {
+    Workload data;
+    if (!isatty(STDIN_FILENO) && args.replications == 0) {
         // Input is from a file/pipe
-        data = parseInput();
+        try {
+            data = loadWorkload(STDIN_FILENO, args.streamInput);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return EXIT_FAILURE;
+        }
     } else {
         // Generate random processes
-        data = generateRandomProcesses();
+        data = generateRandomProcesses(args.numProcesses, seed);
     }
     
     // Define algorithms to run
@@ -190,30 +294,183 @@ int main(int argc, char* argv[]) {
         algorithms = {"FCFS", "SJF", "SRTN", "RR10", "RR50", "RR100"};
     } else {
         // Run only the specified algorithm
-        if (args.algorithm == "FCFS" || args.algorithm == "SJF" || args.algorithm == "SRTN") {
+        MLFQSettings mlfqSettings;
+        FairSettings fairSettings;
+        if (args.algorithm == "FCFS" || args.algorithm == "SJF" || args.algorithm == "SRTN" ||
+            isRoundRobinAlgorithm(args.algorithm) || parseMLFQAlgorithm(args.algorithm, mlfqSettings) ||
+            parseFairAlgorithm(args.algorithm, fairSettings)) {
             algorithms.push_back(args.algorithm);
         } else if (args.algorithm == "RR") {
             // Run all Round Robin variants
             algorithms = {"RR10", "RR50", "RR100"};
         } else {
             std::cerr << "Invalid algorithm: " << args.algorithm << "\n";
-            std::cerr << "Valid algorithms are: FCFS, SJF, SRTN, RR\n";
+            std::cerr << "Valid algorithms are: FCFS, SJF, SRTN, RR, RR<quantum>, "
+                      << "MLFQ[:q0/q1/.../qn[:boost]], CFS[:latency/granularity]\n";
+            return EXIT_FAILURE;
+        }
+    }
+    
+    SimulationOptions options;
+    options.verboseMode = args.verboseMode;
+    options.detailedMode = args.detailedMode;
+    options.eventQueue = args.eventQueue;
+    options.numCores = args.numCores;
+    options.migrationCost = args.migrationCost;
+    options.ioDevices = args.ioDevices;
+    options.analyticFastPath = !args.eventEngineOnly;
+    options.crossCheck = args.crossCheck;
+    options.transitionLogFile = args.transitionLogFile;
+    options.timelineFile = args.timelineFile;
+    options.checkpointInterval = args.checkpointInterval;
+    options.checkpointFile = args.checkpointFile;
+    options.restoreFile = args.restoreFile;
+    
+    // A quantum sweep picks its own Round Robin algorithms
+    if (args.sweepQuantum && !args.algorithm.empty()) {
+        std::cerr << "A quantum sweep (-Q) runs Round Robin over the range and cannot be combined with -a\n";
+        return EXIT_FAILURE;
+    }
+    
+    // A checkpoint holds the state of one run
+    if ((args.checkpointInterval > 0 || !args.restoreFile.empty()) &&
+        (algorithms.size() != 1 || args.sweepQuantum || args.sweepSwitchTime || args.replications > 0)) {
+        std::cerr << "Checkpoints (-C, -r) need a single algorithm and no sweep or replications\n";
+        return EXIT_FAILURE;
+    }
+    
+    // A transition log holds the transitions of one run
+    if (!args.transitionLogFile.empty() && algorithms.size() != 1) {
+        std::cerr << "A transition log (-V) needs a single algorithm\n";
+        return EXIT_FAILURE;
+    }
+    
+    // So does a timeline
+    if (!args.timelineFile.empty() &&
+        (algorithms.size() != 1 || args.sweepQuantum || args.sweepSwitchTime || args.replications > 0 ||
+         !args.edits.empty())) {
+        std::cerr << "A timeline (-T) needs a single algorithm and no sweep, replications or edits\n";
+        return EXIT_FAILURE;
+    }
+    
+    // Incremental mode: a baseline run with snapshots every -C time units,
+    // then the edited workload re-simulated only where it differs
+    if (!args.edits.empty()) {
+        if (algorithms.size() != 1 || args.sweepQuantum || args.sweepSwitchTime || args.replications > 0 ||
+            !args.restoreFile.empty() || data.generated) {
+            std::cerr << "Edits (-e) need input, a single algorithm and no sweep, replications or restore\n";
             return EXIT_FAILURE;
         }
+        
+        try {
+            int interval = args.checkpointInterval > 0 ? args.checkpointInterval : 1000;
+            IncrementalSimulation simulation(algorithms[0], data, options, interval);
+            IncrementalReport report;
+            Statistics edited = simulation.rerun(args.edits, report);
+            
+            Statistics baseline = simulation.getBaseline();
+            std::string schedulerName = createScheduler(algorithms[0], data.processSwitchTime)->getName();
+            for (const Statistics* stats : {&baseline, &edited}) {
+                std::string name = schedulerName + (stats == &edited ? " (edited)" : "");
+                if (args.detailedMode) {
+                    stats->printDetailedOutput(name);
+                } else {
+                    stats->printDefaultOutput(name);
+                }
+                if (args.percentiles) {
+                    stats->printDistributionOutput();
+                }
+                std::cout << "\n";
+            }
+            report.print();
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
     }
     
-    // Run simulations and print results
-    for (const auto& alg : algorithms) {
-        Statistics stats = runSimulation(alg, data, args.verboseMode, args.detailedMode);
+    // Parameter sweep mode: evaluate the whole grid and print it as CSV
+    if (args.sweepQuantum || args.sweepSwitchTime) {
+        if (args.sweepQuantum) {
+            algorithms.clear();
+            for (int quantum : args.quantumRange.values()) {
+                algorithms.push_back("RR" + std::to_string(quantum));
+            }
+        }
+        
+        std::vector<int> switchTimes = args.sweepSwitchTime ? args.switchTimeRange.values()
+                                                            : std::vector<int>{data.processSwitchTime};
+        try {
+            printSweepCsv(runParameterSweep(algorithms, switchTimes, data, options, args.numThreads),
+                          std::cout);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    
+    // Monte Carlo mode: summarise many random workloads per algorithm
+    if (args.replications > 0) {
+        std::vector<ReplicationSummary> summaries;
+        try {
+            summaries = runReplications(algorithms, data, args.replications, seed, options,
+                                        args.numThreads);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return EXIT_FAILURE;
+        }
+        
+        for (const auto& summary : summaries) {
+            summary.print(args.replications, seed);
+            if (&summary != &summaries.back()) {
+                std::cout << "\n";
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+    
+    // Run all simulations in parallel, then print results in order
+    std::vector<SweepResult> results;
+    try {
+        results = runSweep(algorithms, data, options, args.numThreads);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    
+#ifdef SIM_INSTRUMENT
+    if (!args.instrumentationFile.empty()) {
+        std::ofstream out(args.instrumentationFile);
+        out << "[\n";
+        for (const auto& result : results) {
+            out << "  ";
+            result.stats.getInstrumentation().writeJson(out, result.schedulerName);
+            out << (&result != &results.back() ? ",\n" : "\n");
+        }
+        out << "]\n";
+        if (!out) {
+            std::cerr << "Cannot write " << args.instrumentationFile << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+#endif
+    
+    for (const auto& result : results) {
+        std::cout << result.trace;
         
         if (args.detailedMode) {
-            stats.printDetailedOutput(createScheduler(alg, data.processSwitchTime)->getName());
+            result.stats.printDetailedOutput(result.schedulerName);
         } else {
-            stats.printDefaultOutput(createScheduler(alg, data.processSwitchTime)->getName());
+            result.stats.printDefaultOutput(result.schedulerName);
+        }
+        if (args.percentiles) {
+            result.stats.printDistributionOutput();
         }
         
         // Add newline between algorithm outputs
-        if (&alg != &algorithms.back()) {
+        if (&result != &results.back()) {
             std::cout << "\n";
         }
     }
@@ -0,0 +1,66 @@
+#include "mapped_file.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile()
+    : mapping(nullptr), length(0) {
+}
+
+MappedFile::~MappedFile() {
+    if (mapping) {
+        munmap(const_cast<char*>(mapping), length);
+    }
+}
+
+void MappedFile::open(int fd) {
+    // Only map regular files that haven't been partially consumed already
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 &&
+        lseek(fd, 0, SEEK_CUR) == 0) {
+        std::size_t size = static_cast<std::size_t>(info.st_size);
+        void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            madvise(addr, size, MADV_SEQUENTIAL);
+            mapping = static_cast<const char*>(addr);
+            length = size;
+            return;
+        }
+    }
+    
+    // Pipe, terminal or mmap failure: read the whole stream
+    char chunk[1 << 16];
+    for (;;) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("read failed: ") + std::strerror(errno));
+        }
+        buffer.insert(buffer.end(), chunk, chunk + n);
+    }
+    length = buffer.size();
+}
+
+void MappedFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    }
+    
+    try {
+        open(fd);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+}
@@ -0,0 +1,31 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. Regular files are memory-mapped; pipes and
+// other unmappable inputs are read into an owned buffer instead.
+class MappedFile {
+private:
+    const char* mapping;    // Non-null when the file is mapped
+    std::size_t length;
+    std::vector<char> buffer;
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    // Maps (or reads) everything remaining on an open descriptor. Throws
+    // std::runtime_error on I/O failure.
+    void open(int fd);
+    void open(const std::string& path);
+    
+    const char* data() const { return mapping ? mapping : buffer.data(); }
+    std::size_t size() const { return length; }
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,73 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of worker threads to use when the caller does not specify one
+inline unsigned defaultThreadCount() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+// Runs body(i) for every i in [0, count) on up to numThreads worker threads
+// (0 selects the hardware concurrency). Work is handed out one index at a
+// time, so uneven task lengths still balance across threads. The first
+// exception thrown by any task is rethrown on the calling thread.
+template <typename Body>
+void parallelFor(std::size_t count, unsigned numThreads, Body body) {
+    if (numThreads == 0) {
+        numThreads = defaultThreadCount();
+    }
+    numThreads = static_cast<unsigned>(std::min<std::size_t>(numThreads, count));
+    
+    if (numThreads <= 1) {
+        for (std::size_t i = 0; i < count; i++) {
+            body(i);
+        }
+        return;
+    }
+    
+    std::atomic<std::size_t> nextIndex(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    
+    auto worker = [&]() {
+        for (;;) {
+            std::size_t i = nextIndex.fetch_add(1);
+            if (i >= count) {
+                return;
+            }
+            
+            try {
+                body(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                nextIndex = count; // Stop handing out work
+            }
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    for (unsigned t = 0; t < numThreads; t++) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+#endif // PARALLEL_H
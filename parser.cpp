@@ -0,0 +1,167 @@
+#include "parser.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <vector>
+#include "mapped_file.h"
+#include "trace.h"
+
+ParseError::ParseError(const std::string& message, std::size_t offset, std::size_t line)
+    : std::runtime_error(message + " at byte " + std::to_string(offset) +
+                         " (line " + std::to_string(line) + ")"),
+      offset(offset), line(line) {
+}
+
+TextWorkloadReader::TextWorkloadReader(const char* begin, const char* end)
+    : begin(begin), cursor(begin), end(end), numProcesses(0), processSwitchTime(0),
+      processesRead(0), hasNice(false), id(0), arrivalTime(0), nice(0) {
+    // Read number of processes and process switch time
+    hasNice = nextKeyword("nice");
+    if (!nextInt(numProcesses) || !nextInt(processSwitchTime)) {
+        fail("Error reading input file");
+    }
+}
+
+// Reads the next whitespace-separated integer; false on a malformed token or end of input
+bool TextWorkloadReader::nextInt(int& value) {
+    while (cursor != end && static_cast<unsigned char>(*cursor) <= ' ') {
+        cursor++;
+    }
+    
+    std::from_chars_result result = std::from_chars(cursor, end, value);
+    if (result.ec != std::errc() ||
+        (result.ptr != end && static_cast<unsigned char>(*result.ptr) > ' ')) {
+        return false;
+    }
+    cursor = result.ptr;
+    return true;
+}
+
+// Consumes the next token if it is keyword; false, consuming nothing else, otherwise
+bool TextWorkloadReader::nextKeyword(const char* keyword) {
+    while (cursor != end && static_cast<unsigned char>(*cursor) <= ' ') {
+        cursor++;
+    }
+    
+    std::size_t length = std::strlen(keyword);
+    if (static_cast<std::size_t>(end - cursor) < length || std::memcmp(cursor, keyword, length) != 0 ||
+        (cursor + length != end && static_cast<unsigned char>(cursor[length]) > ' ')) {
+        return false;
+    }
+    cursor += length;
+    return true;
+}
+
+void TextWorkloadReader::fail(const std::string& message) const {
+    std::size_t offset = static_cast<std::size_t>(cursor - begin);
+    std::size_t line = 1 + static_cast<std::size_t>(std::count(begin, cursor, '\n'));
+    throw ParseError(message, offset, line);
+}
+
+bool TextWorkloadReader::seek(std::size_t offset, int read) {
+    if (offset > static_cast<std::size_t>(end - begin) || read < 0 || read > numProcesses) {
+        return false;
+    }
+    cursor = begin + offset;
+    processesRead = read;
+    return true;
+}
+
+bool TextWorkloadReader::next() {
+    if (processesRead >= numProcesses) {
+        return false;
+    }
+    
+    int numBursts;
+    if (!nextInt(id) || !nextInt(arrivalTime) || !nextInt(numBursts)) {
+        fail("Error reading process data");
+    }
+    
+    // Nice value, in workloads that declare the column
+    nice = 0;
+    if (hasNice && (!nextInt(nice) || nice < -20 || nice > 19)) {
+        fail("Error reading nice value (expected -20 to 19)");
+    }
+    
+    cpuBursts.clear();
+    ioBursts.clear();
+    
+    for (int j = 0; j < numBursts; j++) {
+        int burstNum, cpuTime;
+        
+        if (!nextInt(burstNum) || !nextInt(cpuTime)) {
+            fail("Error reading CPU burst data");
+        }
+        
+        cpuBursts.push_back(cpuTime);
+        
+        // If this is not the last burst, read I/O time
+        if (j < numBursts - 1) {
+            int ioTime;
+            if (!nextInt(ioTime)) {
+                fail("Error reading I/O burst data");
+            }
+            ioBursts.push_back(ioTime);
+        }
+    }
+    
+    processesRead++;
+    return true;
+}
+
+bool TextWorkloadReader::next(std::shared_ptr<const ProcessSpec>& spec,
+                              std::pmr::memory_resource* memory) {
+    if (!next()) {
+        return false;
+    }
+    
+    spec = std::allocate_shared<ProcessSpec>(std::pmr::polymorphic_allocator<ProcessSpec>(memory),
+                                             id, arrivalTime, cpuBursts, ioBursts, nice, memory);
+    return true;
+}
+
+Workload parseWorkload(const char* begin, const char* end) {
+    Workload data;
+    TextWorkloadReader reader(begin, end);
+    data.processSwitchTime = reader.getProcessSwitchTime();
+    
+    // Every process needs at least four tokens, which bounds a sane reservation
+    std::size_t maxProcesses = static_cast<std::size_t>(end - begin) / 8 + 1;
+    data.processes.reserve(std::min(static_cast<std::size_t>(std::max(reader.getProcessCount(), 0)),
+                                    maxProcesses));
+    
+    while (reader.next()) {
+        data.processes.add(reader.getId(), reader.getArrivalTime(), reader.getNice(),
+                           reader.getCpuBursts(), reader.getIoBursts());
+    }
+    data.processes.bursts.finish();
+    
+    data.indexArrivals();
+    return data;
+}
+
+Workload loadWorkload(int fd, bool streamText) {
+    std::shared_ptr<MappedFile> input = std::make_shared<MappedFile>();
+    input->open(fd);
+    
+    if (isBinaryTrace(input->data(), input->size())) {
+        // The trace keeps the mapping alive for as long as the workload exists
+        Workload data;
+        std::shared_ptr<const BinaryTrace> trace = std::make_shared<const BinaryTrace>(input);
+        data.processSwitchTime = trace->getProcessSwitchTime();
+        data.trace = trace;
+        data.indexArrivals();
+        return data;
+    }
+    
+    if (streamText) {
+        // Only the header is read now; each run parses processes as it admits them
+        Workload data;
+        TextWorkloadReader reader(input->data(), input->data() + input->size());
+        data.processSwitchTime = reader.getProcessSwitchTime();
+        data.text = input;
+        return data;
+    }
+    
+    return parseWorkload(input->data(), input->data() + input->size());
+}
@@ -0,0 +1,90 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include "process.h"
+#include "workload.h"
+
+// Malformed input, located by byte offset and 1-based line number
+class ParseError : public std::runtime_error {
+private:
+    std::size_t offset;
+    std::size_t line;
+
+public:
+    ParseError(const std::string& message, std::size_t offset, std::size_t line);
+    
+    std::size_t getOffset() const { return offset; }
+    std::size_t getLine() const { return line; }
+};
+
+// Incremental reader for the text workload format:
+//   [nice] <process count> <process switch time>
+//   <id> <arrival time> <burst count> [<nice>]
+//   <burst number> <cpu time> <io time>     (every burst but the last)
+//   <burst number> <cpu time>               (last burst)
+// Process lines carry a nice value only when the header starts with the
+// keyword nice; line breaks are insignificant. Tokens are scanned in place
+// with std::from_chars; no copies of the input are made. All methods throw
+// ParseError on malformed input.
+class TextWorkloadReader {
+private:
+    const char* begin;
+    const char* cursor;
+    const char* end;
+    int numProcesses;
+    int processSwitchTime;
+    int processesRead;
+    bool hasNice;   // Header starts with the nice keyword
+    
+    // Fields of the process read last
+    int id;
+    int arrivalTime;
+    int nice;
+    std::vector<int> cpuBursts;
+    std::vector<int> ioBursts;
+    
+    bool nextInt(int& value);
+    bool nextKeyword(const char* keyword);
+    [[noreturn]] void fail(const std::string& message) const;
+
+public:
+    // Reads the header line
+    TextWorkloadReader(const char* begin, const char* end);
+    
+    int getProcessCount() const { return numProcesses; }
+    int getProcessSwitchTime() const { return processSwitchTime; }
+    
+    // Position between processes, for resuming a run from a checkpoint
+    std::size_t getOffset() const { return static_cast<std::size_t>(cursor - begin); }
+    int getProcessesRead() const { return processesRead; }
+    // Continues at a position taken from getOffset/getProcessesRead; false if it is out of range
+    bool seek(std::size_t offset, int processesRead);
+    
+    // Parses the next process into the fields below; false once every process has been read
+    bool next();
+    int getId() const { return id; }
+    int getArrivalTime() const { return arrivalTime; }
+    int getNice() const { return nice; }
+    const std::vector<int>& getCpuBursts() const { return cpuBursts; }
+    const std::vector<int>& getIoBursts() const { return ioBursts; }
+    
+    // Parses the next process into a spec allocated from memory
+    bool next(std::shared_ptr<const ProcessSpec>& spec,
+              std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+};
+
+// Parses a whole text workload into memory
+Workload parseWorkload(const char* begin, const char* end);
+
+// Maps the input behind a file descriptor (or reads it, for pipes). Binary
+// traces are used in place. Text input is parsed into memory, or, when
+// streamText is set, kept mapped and parsed lazily by each run; streamed
+// input must list processes in arrival order.
+Workload loadWorkload(int fd, bool streamText = false);
+
+#endif // PARSER_H
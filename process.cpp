@@ -1,171 +1,384 @@
 #include "process.h"
+#include <algorithm>
+#include "snapshot.h"
+#include "trace.h"
 
-Process::Process(int id, int arrivalTime, const std::vector<int>& cpuBursts, 
-                const std::vector<int>& ioBursts)
-    : id(id), arrivalTime(arrivalTime), cpuBursts(cpuBursts), ioBursts(ioBursts),
-      currentBurst(0), state(ProcessState::NEW), startTime(-1), finishTime(-1),
-      serviceTime(0), ioTime(0), waitTime(0) {
-    
-    // Calculate total CPU and I/O time
-    totalCpuTime = 0;
-    for (int burst : cpuBursts) {
-        totalCpuTime += burst;
-    }
-    
-    totalIoTime = 0;
-    for (int burst : ioBursts) {
-        totalIoTime += burst;
-    }
-    
-    // Initialize remaining time for first burst
-    if (!cpuBursts.empty()) {
-        remainingTimeInBurst = cpuBursts[0];
-    } else {
-        remainingTimeInBurst = 0;
+std::string processStateToString(ProcessState state) {
+    switch (state) {
+        case ProcessState::NEW: return "new";
+        case ProcessState::READY: return "ready";
+        case ProcessState::RUNNING: return "running";
+        case ProcessState::BLOCKED: return "blocked";
+        case ProcessState::TERMINATED: return "terminated";
+        default: return "unknown";
     }
 }
 
-int Process::getId() const {
-    return id;
+ProcessSpec::ProcessSpec(int id, int arrivalTime, const std::vector<int>& cpuBursts,
+                         const std::vector<int>& ioBursts, int nice,
+                         std::pmr::memory_resource* memory)
+    : id(id), arrivalTime(arrivalTime), nice(nice),
+      burstEncoding(chooseBurstEncoding(cpuBursts, ioBursts)), bursts(memory) {
+    appendBursts(cpuBursts, ioBursts, burstEncoding, bursts);
 }
 
-int Process::getArrivalTime() const {
-    return arrivalTime;
+ProcessSpec::ProcessSpec(int id, int arrivalTime, int nice, BurstEncoding burstEncoding,
+                         std::pmr::vector<std::uint8_t>&& bursts)
+    : id(id), arrivalTime(arrivalTime), nice(nice), burstEncoding(burstEncoding),
+      bursts(std::move(bursts)) {
 }
 
-ProcessState Process::getState() const {
-    return state;
+ProcessTable::ProcessTable(std::pmr::memory_resource* memory)
+    : ids(memory), inputOrders(memory), specs(memory), burstCursors(memory), burstEnds(memory),
+      burstEncodings(memory),
+      arrivalTimes(memory), currentBursts(memory), remainingTimes(memory), states(memory),
+      cores(memory), nices(memory), runStarts(memory), runEnds(memory), levels(memory), levelEpochs(memory),
+      vruntimes(memory), accountedServices(memory),
+      startTimes(memory), finishTimes(memory), serviceTimes(memory),
+      ioTimes(memory), waitTimes(memory), readySince(memory), freeHandles(memory) {
 }
 
-void Process::setState(ProcessState newState) {
-    state = newState;
-}
-
-int Process::getCurrentBurst() const {
-    return currentBurst;
+ProcessHandle ProcessTable::addColumns(int id, std::uint64_t inputOrder, int arrivalTime, int nice,
+                                       const BurstRange& bursts) {
+    if (!freeHandles.empty()) {
+        // Reuse the slot of a released process
+        ProcessHandle process = freeHandles.back();
+        freeHandles.pop_back();
+        
+        ids[process] = id;
+        inputOrders[process] = inputOrder;
+        arrivalTimes[process] = arrivalTime;
+        burstCursors[process] = bursts.begin;
+        burstEnds[process] = bursts.end;
+        burstEncodings[process] = bursts.encoding;
+        currentBursts[process] = -1;
+        remainingTimes[process] = 0;
+        states[process] = ProcessState::NEW;
+        cores[process] = 0;
+        nices[process] = static_cast<std::int8_t>(nice);
+        runStarts[process] = 0;
+        runEnds[process] = 0;
+        levels[process] = 0;
+        levelEpochs[process] = 0;
+        vruntimes[process] = 0;
+        accountedServices[process] = 0;
+        startTimes[process] = -1;
+        finishTimes[process] = -1;
+        serviceTimes[process] = 0;
+        ioTimes[process] = 0;
+        waitTimes[process] = 0;
+        readySince[process] = 0;
+        return process;
+    }
+    
+    ProcessHandle process = static_cast<ProcessHandle>(states.size());
+    
+    ids.push_back(id);
+    inputOrders.push_back(inputOrder);
+    specs.push_back(nullptr);
+    burstCursors.push_back(bursts.begin);
+    burstEnds.push_back(bursts.end);
+    burstEncodings.push_back(bursts.encoding);
+    arrivalTimes.push_back(arrivalTime);
+    currentBursts.push_back(-1);
+    remainingTimes.push_back(0);
+    states.push_back(ProcessState::NEW);
+    cores.push_back(0);
+    nices.push_back(static_cast<std::int8_t>(nice));
+    runStarts.push_back(0);
+    runEnds.push_back(0);
+    levels.push_back(0);
+    levelEpochs.push_back(0);
+    vruntimes.push_back(0);
+    accountedServices.push_back(0);
+    startTimes.push_back(-1);
+    finishTimes.push_back(-1);
+    serviceTimes.push_back(0);
+    ioTimes.push_back(0);
+    waitTimes.push_back(0);
+    readySince.push_back(0);
+    
+    return process;
 }
 
-int Process::getRemainingTimeInBurst() const {
-    return remainingTimeInBurst;
+ProcessHandle ProcessTable::add(std::shared_ptr<const ProcessSpec> spec, std::uint64_t inputOrder) {
+    ProcessHandle process = addColumns(spec->id, inputOrder, spec->arrivalTime, spec->nice,
+                                       spec->burstRange());
+    specs[process] = std::move(spec);
+    moveToNextBurst(process);
+    return process;
 }
 
-void Process::setRemainingTimeInBurst(int time) {
-    int oldTime = remainingTimeInBurst;
-    remainingTimeInBurst = time;
-    
-    // If we're setting a smaller time, add the difference to service time
-    if (state == ProcessState::RUNNING && time < oldTime) {
-        serviceTime += (oldTime - time);
-    }
+ProcessHandle ProcessTable::add(const BinaryTrace& trace, std::size_t index) {
+    // Bursts are decoded straight out of the mapping
+    ProcessHandle process = addColumns(trace.getId(index), index, trace.getArrivalTime(index),
+                                       trace.getNice(index), trace.burstRange(index));
+    moveToNextBurst(process);
+    return process;
 }
 
-void Process::decrementRemainingTime(int time) {
-    if (state == ProcessState::RUNNING) {
-        serviceTime += time;
-    } else if (state == ProcessState::BLOCKED) {
-        ioTime += time;
-    }
-    
-    remainingTimeInBurst -= time;
-    if (remainingTimeInBurst < 0) {
-        remainingTimeInBurst = 0;
-    }
+ProcessHandle ProcessTable::add(int id, std::uint64_t inputOrder, int arrivalTime, int nice,
+                                const BurstRange& bursts) {
+    ProcessHandle process = addColumns(id, inputOrder, arrivalTime, nice, bursts);
+    moveToNextBurst(process);
+    return process;
 }
 
-bool Process::hasMoreBursts() const {
-    if (isIoBurst()) {
-        return currentBurst/2 < ioBursts.size();
-    } else {
-        return currentBurst/2 < cpuBursts.size();
-    }
+void ProcessTable::release(ProcessHandle process) {
+    specs[process].reset();
+    burstCursors[process] = nullptr;
+    burstEnds[process] = nullptr;
+    states[process] = ProcessState::TERMINATED;
+    freeHandles.push_back(process);
 }
 
-bool Process::isIoBurst() const {
-    return currentBurst % 2 == 1;
+void ProcessTable::reserve(std::size_t count) {
+    ids.reserve(count);
+    inputOrders.reserve(count);
+    specs.reserve(count);
+    burstCursors.reserve(count);
+    burstEnds.reserve(count);
+    burstEncodings.reserve(count);
+    arrivalTimes.reserve(count);
+    currentBursts.reserve(count);
+    remainingTimes.reserve(count);
+    states.reserve(count);
+    cores.reserve(count);
+    nices.reserve(count);
+    runStarts.reserve(count);
+    runEnds.reserve(count);
+    levels.reserve(count);
+    levelEpochs.reserve(count);
+    vruntimes.reserve(count);
+    accountedServices.reserve(count);
+    startTimes.reserve(count);
+    finishTimes.reserve(count);
+    serviceTimes.reserve(count);
+    ioTimes.reserve(count);
+    waitTimes.reserve(count);
+    readySince.reserve(count);
 }
 
-void Process::moveToNextBurst() {
-    currentBurst++;
+void ProcessTable::setRemainingTimeInBurst(ProcessHandle process, int time) {
+    int oldTime = remainingTimes[process];
+    remainingTimes[process] = time;
     
-    if (isIoBurst()) {
-        if (currentBurst/2 < ioBursts.size()) {
-            remainingTimeInBurst = ioBursts[currentBurst/2];
-        } else {
-            remainingTimeInBurst = 0;
-        }
-    } else {
-        if (currentBurst/2 < cpuBursts.size()) {
-            remainingTimeInBurst = cpuBursts[currentBurst/2];
-        } else {
-            remainingTimeInBurst = 0;
-        }
+    // If we're setting a smaller time, add the difference to service time
+    if (states[process] == ProcessState::RUNNING && time < oldTime) {
+        serviceTimes[process] += (oldTime - time);
     }
 }
 
-void Process::setStartTime(int time) {
-    if (startTime == -1) {
-        startTime = time;
+void ProcessTable::decrementRemainingTime(ProcessHandle process, int time) {
+    if (states[process] == ProcessState::RUNNING) {
+        serviceTimes[process] += time;
+    } else if (states[process] == ProcessState::BLOCKED) {
+        ioTimes[process] += time;
+    }
+    
+    remainingTimes[process] -= time;
+    if (remainingTimes[process] < 0) {
+        remainingTimes[process] = 0;
     }
 }
 
-void Process::setFinishTime(int time) {
-    finishTime = time;
-}
-
-void Process::addServiceTime(int time) {
-    serviceTime += time;
-}
-
-void Process::addIoTime(int time) {
-    ioTime += time;
-}
-
-void Process::addWaitTime(int time) {
-    waitTime += time;
+int ProcessTable::getRemainingTimeAt(ProcessHandle process, int time) const {
+    if (states[process] != ProcessState::RUNNING) {
+        return remainingTimes[process];
+    }
+    return remainingTimes[process] + std::max(runEnds[process] - std::max(time, runStarts[process]), 0);
 }
 
-int Process::getStartTime() const {
-    return startTime;
+int ProcessTable::preemptRun(ProcessHandle process, int time) {
+    int unused = std::max(runEnds[process] - std::max(time, runStarts[process]), 0);
+    remainingTimes[process] += unused;
+    serviceTimes[process] -= unused;
+    runEnds[process] = std::max(time, runStarts[process]);
+    return unused;
 }
 
-int Process::getFinishTime() const {
-    return finishTime;
+bool ProcessTable::hasMoreBursts(ProcessHandle process) const {
+    // The cursor is cleared once the bursts run out
+    return burstCursors[process] != nullptr;
 }
 
-int Process::getServiceTime() const {
-    return serviceTime;
+void ProcessTable::moveToNextBurst(ProcessHandle process) {
+    currentBursts[process]++;
+    
+    const std::uint8_t* cursor = burstCursors[process];
+    if (cursor && cursor != burstEnds[process]) {
+        std::int32_t burst;
+        burstCursors[process] = decodeBurst(cursor, burstEnds[process], burstEncodings[process], burst);
+        remainingTimes[process] = burst;
+    } else {
+        burstCursors[process] = nullptr;
+        remainingTimes[process] = 0;
+    }
 }
 
-int Process::getIoTime() const {
-    return ioTime;
+void ProcessTable::setStartTime(ProcessHandle process, int time) {
+    if (startTimes[process] == -1) {
+        startTimes[process] = time;
+    }
 }
 
-int Process::getWaitTime() const {
-    return waitTime;
+int ProcessTable::getTurnaroundTime(ProcessHandle process) const {
+    if (finishTimes[process] == -1) {
+        return -1; // Process hasn't finished yet
+    }
+    return finishTimes[process] - arrivalTimes[process];
 }
 
-int Process::getTotalCpuTime() const {
-    return totalCpuTime;
+std::string ProcessTable::stateToString(ProcessHandle process) const {
+    return processStateToString(states[process]);
 }
 
-int Process::getTotalIoTime() const {
-    return totalIoTime;
+CanonicalHandles ProcessTable::canonicalHandles() const {
+    // Released slots are the only terminated ones
+    CanonicalHandles canonical;
+    canonical.keys.assign(inputOrders.begin(), inputOrders.end());
+    for (ProcessHandle process = 0; process < size(); process++) {
+        if (states[process] != ProcessState::TERMINATED) {
+            canonical.order.push_back(process);
+        }
+    }
+    std::sort(canonical.order.begin(), canonical.order.end(), [this](ProcessHandle a, ProcessHandle b) {
+        return inputOrders[a] < inputOrders[b];
+    });
+    return canonical;
 }
 
-int Process::getTurnaroundTime() const {
-    if (finishTime == -1) {
-        return -1; // Process hasn't finished yet
+void ProcessTable::save(SnapshotWriter& out) const {
+    if (out.isCanonical()) {
+        // Live processes only, in input order, with their bursts decoded
+        const CanonicalHandles& canonical = out.getCanonicalHandles();
+        std::vector<std::int32_t> bursts;
+        out.write<std::uint64_t>(canonical.order.size());
+        for (ProcessHandle process : canonical.order) {
+            out.write(inputOrders[process]);
+            out.write(ids[process]);
+            out.write(arrivalTimes[process]);
+            out.write(currentBursts[process]);
+            out.write(remainingTimes[process]);
+            out.write(states[process]);
+            out.write(cores[process]);
+            out.write(nices[process]);
+            // Only the run in progress affects the rest of the simulation
+            bool running = states[process] == ProcessState::RUNNING;
+            out.write(running ? runStarts[process] : 0);
+            out.write(running ? runEnds[process] : 0);
+            out.write(vruntimes[process]);
+            out.write(accountedServices[process]);
+            out.write(startTimes[process]);
+            out.write(finishTimes[process]);
+            out.write(serviceTimes[process]);
+            out.write(ioTimes[process]);
+            out.write(waitTimes[process]);
+            out.write(readySince[process]);
+            
+            bursts.clear();
+            const std::uint8_t* cursor = burstCursors[process];
+            while (cursor && cursor != burstEnds[process]) {
+                std::int32_t burst;
+                cursor = decodeBurst(cursor, burstEnds[process], burstEncodings[process], burst);
+                bursts.push_back(burst);
+            }
+            out.writeVector(bursts);
+        }
+        return;
+    }
+    
+    out.writeVector(ids);
+    out.writeVector(inputOrders);
+    out.writeVector(arrivalTimes);
+    out.writeVector(currentBursts);
+    out.writeVector(remainingTimes);
+    out.writeVector(states);
+    out.writeVector(cores);
+    out.writeVector(nices);
+    out.writeVector(runStarts);
+    out.writeVector(runEnds);
+    out.writeVector(levels);
+    out.writeVector(levelEpochs);
+    out.writeVector(vruntimes);
+    out.writeVector(accountedServices);
+    out.writeVector(startTimes);
+    out.writeVector(finishTimes);
+    out.writeVector(serviceTimes);
+    out.writeVector(ioTimes);
+    out.writeVector(waitTimes);
+    out.writeVector(readySince);
+    out.writeVector(freeHandles);
+    
+    // Remaining bursts of each slot; a null cursor is saved as "no bursts"
+    for (ProcessHandle process = 0; process < size(); process++) {
+        const std::uint8_t* cursor = burstCursors[process];
+        out.write<std::uint8_t>(cursor != nullptr);
+        if (cursor) {
+            out.write(burstEncodings[process]);
+            out.writeBytes(cursor, static_cast<std::size_t>(burstEnds[process] - cursor));
+        }
     }
-    return finishTime - arrivalTime;
 }
 
-std::string Process::stateToString() const {
-    switch (state) {
-        case ProcessState::NEW: return "new";
-        case ProcessState::READY: return "ready";
-        case ProcessState::RUNNING: return "running";
-        case ProcessState::BLOCKED: return "blocked";
-        case ProcessState::TERMINATED: return "terminated";
-        default: return "unknown";
+void ProcessTable::restore(SnapshotReader& in) {
+    in.readVector(ids);
+    in.readVector(inputOrders);
+    in.readVector(arrivalTimes);
+    in.readVector(currentBursts);
+    in.readVector(remainingTimes);
+    in.readVector(states);
+    in.readVector(cores);
+    in.readVector(nices);
+    in.readVector(runStarts);
+    in.readVector(runEnds);
+    in.readVector(levels);
+    in.readVector(levelEpochs);
+    in.readVector(vruntimes);
+    in.readVector(accountedServices);
+    in.readVector(startTimes);
+    in.readVector(finishTimes);
+    in.readVector(serviceTimes);
+    in.readVector(ioTimes);
+    in.readVector(waitTimes);
+    in.readVector(readySince);
+    in.readVector(freeHandles);
+    
+    std::size_t count = ids.size();
+    bool consistent = inputOrders.size() == count && arrivalTimes.size() == count &&
+                      currentBursts.size() == count && remainingTimes.size() == count &&
+                      states.size() == count && cores.size() == count && nices.size() == count &&
+                      runStarts.size() == count && runEnds.size() == count &&
+                      levels.size() == count && levelEpochs.size() == count &&
+                      vruntimes.size() == count && accountedServices.size() == count &&
+                      startTimes.size() == count && finishTimes.size() == count &&
+                      serviceTimes.size() == count && ioTimes.size() == count &&
+                      waitTimes.size() == count && readySince.size() == count &&
+                      freeHandles.size() <= count;
+    for (ProcessHandle process : freeHandles) {
+        consistent = consistent && process < count;
+    }
+    in.expect(consistent, "corrupt checkpoint");
+    
+    std::pmr::memory_resource* memory = ids.get_allocator().resource();
+    specs.assign(count, nullptr);
+    burstCursors.assign(count, nullptr);
+    burstEnds.assign(count, nullptr);
+    burstEncodings.assign(count, BurstEncoding::VARINT);
+    for (ProcessHandle process = 0; process < count; process++) {
+        if (in.read<std::uint8_t>() == 0) {
+            continue;
+        }
+        
+        BurstEncoding encoding = in.read<BurstEncoding>();
+        std::pmr::vector<std::uint8_t> bursts(memory);
+        in.readVector(bursts);
+        auto spec = std::allocate_shared<ProcessSpec>(std::pmr::polymorphic_allocator<ProcessSpec>(memory),
+                                                      ids[process], arrivalTimes[process], nices[process],
+                                                      encoding, std::move(bursts));
+        burstCursors[process] = spec->bursts.data();
+        burstEnds[process] = spec->bursts.data() + spec->bursts.size();
+        burstEncodings[process] = encoding;
+        specs[process] = std::move(spec);
     }
 }
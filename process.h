@@ -1,10 +1,14 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include <vector>
 #include <string>
+#include "burst_pool.h"
 
-enum class ProcessState {
+enum class ProcessState : std::uint8_t {
     NEW,
     READY,
     RUNNING,
@@ -12,58 +16,159 @@ enum class ProcessState {
     TERMINATED
 };
 
-class Process {
-private:
+std::string processStateToString(ProcessState state);
+
+// Processes are referred to by their index in the ProcessTable of a run
+using ProcessHandle = std::uint32_t;
+constexpr ProcessHandle NO_PROCESS = UINT32_MAX;
+
+// Immutable description of a single process created on the fly by a
+// streaming arrival source. Its bursts are encoded into one buffer of its own,
+// laid out like an entry of a BurstPool; all per-run state lives in ProcessTable.
+struct ProcessSpec {
     int id;
     int arrivalTime;
-    std::vector<int> cpuBursts;
-    std::vector<int> ioBursts;
-    int currentBurst;
-    int remainingTimeInBurst;
-    ProcessState state;
+    int nice;           // -20 (highest weight) to 19, used by the fair scheduler
+    BurstEncoding burstEncoding;
+    std::pmr::vector<std::uint8_t> bursts;
+    
+    ProcessSpec(int id, int arrivalTime, const std::vector<int>& cpuBursts,
+                const std::vector<int>& ioBursts, int nice = 0,
+                std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    // Takes bursts that are already encoded
+    ProcessSpec(int id, int arrivalTime, int nice, BurstEncoding burstEncoding,
+                std::pmr::vector<std::uint8_t>&& bursts);
+    
+    BurstRange burstRange() const {
+        return BurstRange{bursts.data(), bursts.data() + bursts.size(), burstEncoding};
+    }
+};
+
+class BinaryTrace;
+class SnapshotReader;
+class SnapshotWriter;
+struct CanonicalHandles;
+
+// Per-run process state stored as contiguous columns, one entry per active
+// process. Slots of released processes are reused, so the table only grows
+// with the number of processes alive at once. Every process walks its encoded
+// bursts with a cursor. The bursts live in a spec, which the table keeps
+// alive, or in a BurstPool or mapped binary trace, which must outlive the
+// table. All columns allocate from the run's memory resource.
+class ProcessTable {
+private:
+    std::pmr::vector<int> ids;
+    std::pmr::vector<std::uint64_t> inputOrders;                // Position in the workload input
+    std::pmr::vector<std::shared_ptr<const ProcessSpec>> specs; // Null unless bursts live in a spec
+    std::pmr::vector<const std::uint8_t*> burstCursors;         // Next encoded burst, null when done
+    std::pmr::vector<const std::uint8_t*> burstEnds;
+    std::pmr::vector<BurstEncoding> burstEncodings;
+    std::pmr::vector<int> arrivalTimes;
+    std::pmr::vector<int> currentBursts;
+    std::pmr::vector<int> remainingTimes;
+    std::pmr::vector<ProcessState> states;
+    std::pmr::vector<std::uint16_t> cores;   // CPU the process last ran or queued on
+    std::pmr::vector<std::int8_t> nices;
+    std::pmr::vector<int> runStarts;    // When the current or last CPU run started
+    std::pmr::vector<int> runEnds;      // When it is due to end
+    std::pmr::vector<std::uint8_t> levels;          // MLFQ priority level
+    std::pmr::vector<std::uint32_t> levelEpochs;    // MLFQ boost period the level was set in
+    std::pmr::vector<std::uint64_t> vruntimes;      // Fair scheduler virtual runtime
+    std::pmr::vector<int> accountedServices;        // Service time already charged to vruntime
     
     // Statistics
-    int startTime;      // When process first entered CPU
-    int finishTime;     // When process terminated
-    int serviceTime;    // Total CPU time
-    int ioTime;         // Total I/O time
-    int waitTime;       // Total time in ready queue
-    int totalCpuTime;   // Sum of all CPU bursts
-    int totalIoTime;    // Sum of all I/O bursts
+    std::pmr::vector<int> startTimes;    // When process first entered CPU
+    std::pmr::vector<int> finishTimes;   // When process terminated
+    std::pmr::vector<int> serviceTimes;  // Total CPU time
+    std::pmr::vector<int> ioTimes;       // Total I/O time
+    std::pmr::vector<int> waitTimes;     // Total time in ready queue
+    std::pmr::vector<int> readySince;    // When the process last entered the ready queue
+    
+    std::pmr::vector<ProcessHandle> freeHandles;
 
 public:
-    Process(int id, int arrivalTime, const std::vector<int>& cpuBursts, 
-            const std::vector<int>& ioBursts);
+    explicit ProcessTable(std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    
+    ProcessHandle add(std::shared_ptr<const ProcessSpec> spec, std::uint64_t inputOrder);
+    ProcessHandle add(const BinaryTrace& trace, std::size_t index);
+    ProcessHandle add(int id, std::uint64_t inputOrder, int arrivalTime, int nice, const BurstRange& bursts);
+    void release(ProcessHandle process);
+    void reserve(std::size_t count);
+    
+    // Number of slots, including released ones; handles are always below this
+    std::size_t size() const { return states.size(); }
+    std::size_t activeCount() const { return states.size() - freeHandles.size(); }
+    
+    int getId(ProcessHandle process) const { return ids[process]; }
+    std::uint64_t getInputOrder(ProcessHandle process) const { return inputOrders[process]; }
+    int getArrivalTime(ProcessHandle process) const { return arrivalTimes[process]; }
+    ProcessState getState(ProcessHandle process) const { return states[process]; }
+    void setState(ProcessHandle process, ProcessState newState) { states[process] = newState; }
+    int getNice(ProcessHandle process) const { return nices[process]; }
+    int getCore(ProcessHandle process) const { return cores[process]; }
+    void setCore(ProcessHandle process, int core) { cores[process] = static_cast<std::uint16_t>(core); }
+    int getCurrentBurst(ProcessHandle process) const { return currentBursts[process]; }
+    int getRemainingTimeInBurst(ProcessHandle process) const { return remainingTimes[process]; }
+    void setRemainingTimeInBurst(ProcessHandle process, int time);
+    void decrementRemainingTime(ProcessHandle process, int time);
+    bool hasMoreBursts(ProcessHandle process) const;
+    bool isIoBurst(ProcessHandle process) const { return currentBursts[process] % 2 == 1; }
+    void moveToNextBurst(ProcessHandle process);
+    
+    // A run hands the CPU time it was dispatched for over as service time up
+    // front; these track it so a preempted run can give back what it did not use
+    void setRun(ProcessHandle process, int start, int end) { runStarts[process] = start; runEnds[process] = end; }
+    int getRunEnd(ProcessHandle process) const { return runEnds[process]; }
+    // Priority level kept for MLFQ, so it follows the process across cores
+    int getLevel(ProcessHandle process) const { return levels[process]; }
+    std::uint32_t getLevelEpoch(ProcessHandle process) const { return levelEpochs[process]; }
+    void setLevel(ProcessHandle process, int level, std::uint32_t epoch) {
+        levels[process] = static_cast<std::uint8_t>(level);
+        levelEpochs[process] = epoch;
+    }
     
-    int getId() const;
-    int getArrivalTime() const;
-    ProcessState getState() const;
-    void setState(ProcessState newState);
-    int getCurrentBurst() const;
-    int getRemainingTimeInBurst() const;
-    void setRemainingTimeInBurst(int time);
-    void decrementRemainingTime(int time);
-    bool hasMoreBursts() const;
-    bool isIoBurst() const;
-    void moveToNextBurst();
+    // Virtual runtime kept for the fair scheduler, likewise
+    std::uint64_t getVruntime(ProcessHandle process) const { return vruntimes[process]; }
+    int getAccountedService(ProcessHandle process) const { return accountedServices[process]; }
+    void setVruntime(ProcessHandle process, std::uint64_t vruntime, int accountedService) {
+        vruntimes[process] = vruntime;
+        accountedServices[process] = accountedService;
+    }
+    
+    // Remaining time of the current burst at time, counting what a running
+    // process has left of its run
+    int getRemainingTimeAt(ProcessHandle process, int time) const;
+    // Ends the run of a running process at time; returns the time it gave back
+    int preemptRun(ProcessHandle process, int time);
     
     // Statistics methods
-    void setStartTime(int time);
-    void setFinishTime(int time);
-    void addServiceTime(int time);
-    void addIoTime(int time);
-    void addWaitTime(int time);
+    void setStartTime(ProcessHandle process, int time);
+    void setFinishTime(ProcessHandle process, int time) { finishTimes[process] = time; }
+    void addServiceTime(ProcessHandle process, int time) { serviceTimes[process] += time; }
+    void addIoTime(ProcessHandle process, int time) { ioTimes[process] += time; }
+    void addWaitTime(ProcessHandle process, int time) { waitTimes[process] += time; }
+    void setReadySince(ProcessHandle process, int time) { readySince[process] = time; }
+    int getReadySince(ProcessHandle process) const { return readySince[process]; }
+    
+    int getStartTime(ProcessHandle process) const { return startTimes[process]; }
+    int getFinishTime(ProcessHandle process) const { return finishTimes[process]; }
+    int getServiceTime(ProcessHandle process) const { return serviceTimes[process]; }
+    int getIoTime(ProcessHandle process) const { return ioTimes[process]; }
+    int getWaitTime(ProcessHandle process) const { return waitTimes[process]; }
+    int getTurnaroundTime(ProcessHandle process) const;
     
-    int getStartTime() const;
-    int getFinishTime() const;
-    int getServiceTime() const;
-    int getIoTime() const;
-    int getWaitTime() const;
-    int getTotalCpuTime() const;
-    int getTotalIoTime() const;
-    int getTurnaroundTime() const;
+    std::string stateToString(ProcessHandle process) const;
     
-    std::string stateToString() const;
+    // Checkpointing. Every slot is saved with the bursts it has not used yet;
+    // restored processes keep those bursts in a spec of their own.
+    void save(SnapshotWriter& out) const;
+    void restore(SnapshotReader& in);
+    // Input positions of the live processes, for canonical snapshots
+    CanonicalHandles canonicalHandles() const;
+
+private:
+    ProcessHandle addColumns(int id, std::uint64_t inputOrder, int arrivalTime, int nice,
+                             const BurstRange& bursts);
 };
 
-#endif // PROCESS_H
\ No newline at end of file
+#endif // PROCESS_H
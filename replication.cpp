@@ -0,0 +1,134 @@
+#include "replication.h"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "parallel.h"
+#include "scheduler.h"
+#include "sweep.h"
+
+namespace {
+
+// Two-sided 95% critical values of Student's t for 1..30 degrees of freedom
+const double T_CRITICAL_95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+double tCritical95(std::size_t degreesOfFreedom) {
+    if (degreesOfFreedom <= 30) {
+        return T_CRITICAL_95[degreesOfFreedom - 1];
+    }
+    
+    // Cornish-Fisher expansion around the normal quantile
+    const double z = 1.959964;
+    double df = static_cast<double>(degreesOfFreedom);
+    return z + (z * z * z + z) / (4.0 * df) +
+           (5.0 * std::pow(z, 5) + 16.0 * z * z * z + 3.0 * z) / (96.0 * df * df);
+}
+
+std::uint64_t splitMix64(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+void printEstimate(const std::string& label, const Estimate& estimate, const std::string& unit) {
+    std::cout << label << " is " << estimate.mean << " +/- " << estimate.halfWidth << unit << "\n";
+}
+
+} // namespace
+
+Estimate estimateMean(const std::vector<double>& samples) {
+    Estimate estimate;
+    if (samples.empty()) {
+        return estimate;
+    }
+    
+    // Welford's update keeps the variance numerically stable
+    double mean = 0.0;
+    double m2 = 0.0;
+    for (std::size_t i = 0; i < samples.size(); i++) {
+        double delta = samples[i] - mean;
+        mean += delta / static_cast<double>(i + 1);
+        m2 += delta * (samples[i] - mean);
+    }
+    
+    estimate.mean = mean;
+    if (samples.size() > 1) {
+        double n = static_cast<double>(samples.size());
+        double variance = m2 / (n - 1.0);
+        estimate.halfWidth = tCritical95(samples.size() - 1) * std::sqrt(variance / n);
+    }
+    return estimate;
+}
+
+std::uint64_t replicationSeed(std::uint64_t baseSeed, int index) {
+    return splitMix64(baseSeed ^ splitMix64(static_cast<std::uint64_t>(index)));
+}
+
+void ReplicationSummary::print(int replications, std::uint64_t baseSeed) const {
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    
+    std::cout << schedulerName << " (" << replications << " replications, seed " << baseSeed
+              << ", 95% confidence):\n";
+    std::cout << std::fixed << std::setprecision(2);
+    printEstimate("Total Time required", totalTime, " time units");
+    printEstimate("CPU Utilization", cpuUtilization, "%");
+    printEstimate("Mean Turnaround Time", meanTurnaroundTime, " time units");
+    
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+std::vector<ReplicationSummary> runReplications(const std::vector<std::string>& algorithms,
+                                                const Workload& generator, int replications,
+                                                std::uint64_t baseSeed,
+                                                const SimulationOptions& options,
+                                                unsigned numThreads) {
+    std::size_t numAlgorithms = algorithms.size();
+    std::size_t numReplications = replications > 0 ? static_cast<std::size_t>(replications) : 0;
+    
+    // One workload per replication, each with its own random stream
+    std::vector<Workload> workloads(numReplications, generator);
+    for (std::size_t r = 0; r < numReplications; r++) {
+        workloads[r].generated = true;
+        workloads[r].generator.seed = replicationSeed(baseSeed, static_cast<int>(r));
+    }
+    
+    // Results indexed by [replication * numAlgorithms + algorithm]
+    std::vector<Statistics> results(numReplications * numAlgorithms);
+    SimulationOptions quietOptions = options;
+    quietOptions.verboseMode = false;
+    quietOptions.detailedMode = false;
+    
+    parallelFor(results.size(), numThreads, [&](std::size_t task) {
+        std::size_t r = task / numAlgorithms;
+        std::size_t a = task % numAlgorithms;
+        std::ostringstream unusedTrace;
+        results[task] = runSimulation(algorithms[a], workloads[r], quietOptions, unusedTrace);
+    });
+    
+    std::vector<ReplicationSummary> summaries(numAlgorithms);
+    for (std::size_t a = 0; a < numAlgorithms; a++) {
+        std::vector<double> totalTimes, utilizations, turnarounds;
+        for (std::size_t r = 0; r < numReplications; r++) {
+            const Statistics& stats = results[r * numAlgorithms + a];
+            totalTimes.push_back(stats.getTotalTime());
+            utilizations.push_back(stats.getCpuUtilization());
+            turnarounds.push_back(stats.getMeanTurnaroundTime());
+        }
+        
+        ReplicationSummary& summary = summaries[a];
+        summary.algorithm = algorithms[a];
+        summary.schedulerName = createScheduler(algorithms[a], generator.processSwitchTime)->getName();
+        summary.totalTime = estimateMean(totalTimes);
+        summary.cpuUtilization = estimateMean(utilizations);
+        summary.meanTurnaroundTime = estimateMean(turnarounds);
+    }
+    
+    return summaries;
+}
@@ -0,0 +1,45 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "simulator.h"
+#include "workload.h"
+
+// Sample mean with the half-width of its 95% confidence interval
+struct Estimate {
+    double mean;
+    double halfWidth;
+    
+    Estimate() : mean(0.0), halfWidth(0.0) {}
+};
+
+// Student-t based 95% confidence interval for the mean of samples
+Estimate estimateMean(const std::vector<double>& samples);
+
+// Per-algorithm summary over all replications
+struct ReplicationSummary {
+    std::string algorithm;
+    std::string schedulerName;
+    Estimate totalTime;
+    Estimate cpuUtilization;
+    Estimate meanTurnaroundTime;
+    
+    void print(int replications, std::uint64_t baseSeed) const;
+};
+
+// Seed of replication `index`; streams are independent of each other and of
+// the number of threads used
+std::uint64_t replicationSeed(std::uint64_t baseSeed, int index);
+
+// Runs every algorithm on `replications` random workloads generated from
+// `generator` with per-replication seeds derived from baseSeed. All
+// (replication, algorithm) pairs run in parallel on the thread pool.
+std::vector<ReplicationSummary> runReplications(const std::vector<std::string>& algorithms,
+                                                const Workload& generator, int replications,
+                                                std::uint64_t baseSeed,
+                                                const SimulationOptions& options,
+                                                unsigned numThreads = 0);
+
+#endif // REPLICATION_H
@@ -3,7 +3,7 @@
 #include <sstream>
 
 Scheduler::Scheduler(const std::string& name, int processSwitchTime)
-    : name(name), processSwitchTime(processSwitchTime), timeQuantum(0) {
+    : name(name), processSwitchTime(processSwitchTime), timeQuantum(0), processTable(nullptr) {
 }
 
 std::string Scheduler::getName() const {
@@ -14,163 +14,362 @@ int Scheduler::getProcessSwitchTime() const {
     return processSwitchTime;
 }
 
-// FCFS Scheduler Implementation
-FCFSScheduler::FCFSScheduler(int processSwitchTime)
-    : Scheduler("First Come First Serve", processSwitchTime) {
+void Scheduler::setProcessTable(ProcessTable* table) {
+    processTable = table;
 }
 
-void FCFSScheduler::addProcess(std::shared_ptr<Process> process) {
-    readyQueue.push(process);
+namespace {
+
+// FIFO run queues are saved front to back
+void saveQueue(SnapshotWriter& out, std::queue<ProcessHandle, std::pmr::deque<ProcessHandle>> queue) {
+    out.write<std::uint64_t>(queue.size());
+    for (; !queue.empty(); queue.pop()) {
+        out.writeHandle(queue.front());
+    }
 }
 
-std::shared_ptr<Process> FCFSScheduler::getNextProcess() {
-    if (readyQueue.empty()) {
-        return nullptr;
+void restoreQueue(SnapshotReader& in, std::size_t processCount,
+                  std::queue<ProcessHandle, std::pmr::deque<ProcessHandle>>& queue) {
+    std::size_t count = static_cast<std::size_t>(in.readSize(processCount));
+    while (!queue.empty()) {
+        queue.pop();
+    }
+    for (std::size_t i = 0; i < count; i++) {
+        ProcessHandle process = in.read<ProcessHandle>();
+        in.expect(process < processCount, "corrupt checkpoint");
+        queue.push(process);
     }
-    
-    std::shared_ptr<Process> next = readyQueue.front();
-    readyQueue.pop();
-    return next;
 }
 
-bool FCFSScheduler::hasProcesses() const {
-    return !readyQueue.empty();
+} // namespace
+
+// FCFS Scheduler Implementation
+FCFSScheduler::FCFSScheduler(int processSwitchTime, std::pmr::memory_resource* memory)
+    : Scheduler("First Come First Serve", processSwitchTime),
+      readyQueue(std::pmr::deque<ProcessHandle>(memory)) {
 }
 
-bool FCFSScheduler::shouldPreempt(std::shared_ptr<Process> runningProcess, 
-                                 std::shared_ptr<Process> newProcess, int currentTime) {
-    // FCFS is non-preemptive
-    return false;
+void FCFSScheduler::save(SnapshotWriter& out) const {
+    saveQueue(out, readyQueue);
 }
 
-int FCFSScheduler::getTimeSlice() const {
-    // FCFS doesn't use time slices
-    return -1;
+void FCFSScheduler::restore(SnapshotReader& in) {
+    restoreQueue(in, processTable->size(), readyQueue);
 }
 
 // SJF Scheduler Implementation
-SJFScheduler::SJFScheduler(int processSwitchTime)
-    : Scheduler("Shortest Job First", processSwitchTime) {
+SJFScheduler::SJFScheduler(int processSwitchTime, std::pmr::memory_resource* memory)
+    : Scheduler("Shortest Job First", processSwitchTime), readyQueue(memory) {
 }
 
-void SJFScheduler::addProcess(std::shared_ptr<Process> process) {
-    readyQueue.push(process);
+void SJFScheduler::save(SnapshotWriter& out) const {
+    readyQueue.save(out);
 }
 
-std::shared_ptr<Process> SJFScheduler::getNextProcess() {
-    if (readyQueue.empty()) {
-        return nullptr;
-    }
-    
-    std::shared_ptr<Process> next = readyQueue.top();
-    readyQueue.pop();
-    return next;
+void SJFScheduler::restore(SnapshotReader& in) {
+    readyQueue.restore(in, processTable->size());
 }
 
-bool SJFScheduler::hasProcesses() const {
-    return !readyQueue.empty();
+// SRTN Scheduler Implementation
+SRTNScheduler::SRTNScheduler(int processSwitchTime, std::pmr::memory_resource* memory)
+    : Scheduler("Shortest Remaining Time Next", processSwitchTime), readyQueue(memory) {
 }
 
-bool SJFScheduler::shouldPreempt(std::shared_ptr<Process> runningProcess, 
-                                std::shared_ptr<Process> newProcess, int currentTime) {
-    // SJF is non-preemptive
-    return false;
+void SRTNScheduler::save(SnapshotWriter& out) const {
+    readyQueue.save(out);
 }
 
-int SJFScheduler::getTimeSlice() const {
-    // SJF doesn't use time slices
-    return -1;
+void SRTNScheduler::restore(SnapshotReader& in) {
+    readyQueue.restore(in, processTable->size());
 }
 
-// SRTN Scheduler Implementation
-SRTNScheduler::SRTNScheduler(int processSwitchTime)
-    : Scheduler("Shortest Remaining Time Next", processSwitchTime) {
+// RR Scheduler Implementation
+RRScheduler::RRScheduler(int processSwitchTime, int timeQuantum, std::pmr::memory_resource* memory)
+    : Scheduler("Round Robin", processSwitchTime), readyQueue(std::pmr::deque<ProcessHandle>(memory)) {
+    this->timeQuantum = timeQuantum;
+    
+    // Add time quantum to the name for clarity
+    std::stringstream ss;
+    ss << name << " (quantum=" << timeQuantum << ")";
+    name = ss.str();
 }
 
-void SRTNScheduler::addProcess(std::shared_ptr<Process> process) {
-    readyQueue.push(process);
+void RRScheduler::save(SnapshotWriter& out) const {
+    saveQueue(out, readyQueue);
 }
 
-std::shared_ptr<Process> SRTNScheduler::getNextProcess() {
-    if (readyQueue.empty()) {
-        return nullptr;
-    }
-    
-    std::shared_ptr<Process> next = readyQueue.top();
-    readyQueue.pop();
-    return next;
+void RRScheduler::restore(SnapshotReader& in) {
+    restoreQueue(in, processTable->size(), readyQueue);
 }
 
-bool SRTNScheduler::hasProcesses() const {
-    return !readyQueue.empty();
+// MLFQ Scheduler Implementation
+MLFQScheduler::MLFQScheduler(int processSwitchTime, const MLFQSettings& settings,
+                             std::pmr::memory_resource* memory)
+    : Scheduler("Multilevel Feedback Queue", processSwitchTime), quanta(settings.quanta),
+      boostPeriod(settings.boostPeriod), nextBoost(settings.boostPeriod),
+      levels(std::min(settings.quanta.size(), MAX_LEVELS), memory), nonEmptyLevels(0), readyCount(0),
+      boostEpoch(0) {
+    quanta.resize(levels.size());
+    
+    std::stringstream ss;
+    ss << name << " (quanta=";
+    for (std::size_t i = 0; i < quanta.size(); i++) {
+        ss << (i ? "/" : "") << quanta[i];
+    }
+    ss << ", boost=" << boostPeriod << ")";
+    name = ss.str();
 }
 
-bool SRTNScheduler::shouldPreempt(std::shared_ptr<Process> runningProcess, 
-                                 std::shared_ptr<Process> newProcess, int currentTime) {
-    // Preempt if the new process has a shorter remaining time
-    return newProcess->getRemainingTimeInBurst() < runningProcess->getRemainingTimeInBurst();
+void MLFQScheduler::boost(int currentTime) {
+    // Everything queued moves to level 0, higher levels first to keep their order.
+    // Epochs count boost periods, so every core agrees on which came first.
+    boostEpoch = static_cast<std::uint32_t>(currentTime / boostPeriod);
+    for (std::size_t level = 1; level < levels.size(); level++) {
+        for (ProcessHandle process : levels[level]) {
+            levels[0].push_back(process);
+        }
+        levels[level].clear();
+    }
+    for (ProcessHandle process : levels[0]) {
+        setLevel(process, 0);
+    }
+    nonEmptyLevels = levels[0].empty() ? 0 : 1;
 }
 
-int SRTNScheduler::getTimeSlice() const {
-    // SRTN doesn't use time slices
-    return -1;
+void MLFQScheduler::save(SnapshotWriter& out) const {
+    out.write(nextBoost);
+    if (!out.isCanonical()) {
+        out.write(boostEpoch);
+    }
+    out.write<std::uint64_t>(levels.size());
+    for (const auto& level : levels) {
+        out.write<std::uint64_t>(level.size());
+        for (ProcessHandle process : level) {
+            out.writeHandle(process);
+        }
+    }
+    
+    // Canonically only the levels in effect for live processes count
+    if (out.isCanonical()) {
+        for (ProcessHandle process : out.getCanonicalHandles().order) {
+            out.write(static_cast<std::uint8_t>(levelOf(process)));
+        }
+    }
 }
 
-// RR Scheduler Implementation
-RRScheduler::RRScheduler(int processSwitchTime, int timeQuantum)
-    : Scheduler("Round Robin", processSwitchTime) {
-    this->timeQuantum = timeQuantum;
+void MLFQScheduler::restore(SnapshotReader& in) {
+    std::size_t processCount = processTable->size();
+    in.read(nextBoost);
+    in.read(boostEpoch);
+    in.expect(in.read<std::uint64_t>() == levels.size(), "checkpoint was taken with a different scheduler");
     
-    // Add time quantum to the name for clarity
+    nonEmptyLevels = 0;
+    readyCount = 0;
+    for (std::size_t level = 0; level < levels.size(); level++) {
+        std::size_t count = static_cast<std::size_t>(in.readSize(processCount));
+        levels[level].clear();
+        for (std::size_t i = 0; i < count; i++) {
+            ProcessHandle process = in.read<ProcessHandle>();
+            in.expect(process < processCount, "corrupt checkpoint");
+            levels[level].push_back(process);
+        }
+        if (count > 0) {
+            nonEmptyLevels |= std::uint64_t(1) << level;
+        }
+        readyCount += count;
+    }
+    
+    // Levels were restored with the process table
+    bool valid = true;
+    for (ProcessHandle process = 0; process < processCount; process++) {
+        valid = valid && static_cast<std::size_t>(processTable->getLevel(process)) < levels.size();
+    }
+    in.expect(valid, "corrupt checkpoint");
+}
+
+// Fair Scheduler Implementation
+int niceToWeight(int nice) {
+    static const int weights[40] = {
+        /* -20 */ 88761, 71755, 56483, 46273, 36291,
+        /* -15 */ 29154, 23254, 18705, 14949, 11916,
+        /* -10 */  9548,  7620,  6100,  4904,  3906,
+        /*  -5 */  3121,  2501,  1991,  1586,  1277,
+        /*   0 */  1024,   820,   655,   526,   423,
+        /*   5 */   335,   272,   215,   172,   137,
+        /*  10 */   110,    87,    70,    56,    45,
+        /*  15 */    36,    29,    23,    18,    15,
+    };
+    return weights[std::min(std::max(nice, -20), 19) + 20];
+}
+
+FairScheduler::FairScheduler(int processSwitchTime, const FairSettings& settings,
+                             std::pmr::memory_resource* memory)
+    : Scheduler("Completely Fair", processSwitchTime), runnable(memory),
+      targetLatency(settings.targetLatency), minGranularity(settings.minGranularity), minVruntime(0),
+      runnableWeight(0), nextSequence(0) {
     std::stringstream ss;
-    ss << name << " (quantum=" << timeQuantum << ")";
+    ss << name << " (latency=" << targetLatency << ", granularity=" << minGranularity << ")";
     name = ss.str();
 }
 
-void RRScheduler::addProcess(std::shared_ptr<Process> process) {
-    readyQueue.push(process);
+void FairScheduler::save(SnapshotWriter& out) const {
+    bool canonical = out.isCanonical();
+    out.write(minVruntime);
+    out.write(runnableWeight);
+    if (!canonical) {
+        out.write(nextSequence);
+    }
+    out.write<std::uint64_t>(runnable.size());
+    for (const RunnableEntry& entry : runnable) {
+        out.write(entry.vruntime);
+        if (!canonical) {
+            out.write(entry.sequence);
+        }
+        out.writeHandle(entry.process);
+    }
 }
 
-std::shared_ptr<Process> RRScheduler::getNextProcess() {
-    if (readyQueue.empty()) {
-        return nullptr;
-    }
+void FairScheduler::restore(SnapshotReader& in) {
+    std::size_t processCount = processTable->size();
+    in.read(minVruntime);
+    in.read(runnableWeight);
+    in.read(nextSequence);
     
-    std::shared_ptr<Process> next = readyQueue.front();
-    readyQueue.pop();
-    return next;
+    std::size_t count = static_cast<std::size_t>(in.readSize(processCount));
+    runnable.clear();
+    for (std::size_t i = 0; i < count; i++) {
+        RunnableEntry entry;
+        in.read(entry.vruntime);
+        in.read(entry.sequence);
+        in.read(entry.process);
+        in.expect(entry.process < processCount, "corrupt checkpoint");
+        runnable.insert(runnable.end(), entry);
+    }
 }
 
-bool RRScheduler::hasProcesses() const {
-    return !readyQueue.empty();
+bool isRoundRobinAlgorithm(const std::string& algorithm) {
+    return algorithm.size() > 2 && algorithm.compare(0, 2, "RR") == 0 &&
+           algorithm.size() <= 11 &&
+           std::all_of(algorithm.begin() + 2, algorithm.end(),
+                       [](char c) { return c >= '0' && c <= '9'; }) &&
+           std::stol(algorithm.substr(2)) > 0;
 }
 
-bool RRScheduler::shouldPreempt(std::shared_ptr<Process> runningProcess, 
-                               std::shared_ptr<Process> newProcess, int currentTime) {
-    // Round Robin preempts based on time slice, not on process arrival
-    return false;
+bool parseMLFQAlgorithm(const std::string& algorithm, MLFQSettings& settings) {
+    if (algorithm.compare(0, 4, "MLFQ") != 0) {
+        return false;
+    }
+    if (algorithm.size() == 4) {
+        settings = MLFQSettings();
+        return true;
+    }
+    if (algorithm[4] != ':') {
+        return false;
+    }
+    
+    // Positive integers separated by '/', then an optional ":boost"
+    MLFQSettings parsed;
+    parsed.quanta.clear();
+    std::string quanta = algorithm.substr(5);
+    std::size_t colon = quanta.find(':');
+    if (colon != std::string::npos) {
+        std::string boost = quanta.substr(colon + 1);
+        quanta.erase(colon);
+        if (boost.empty() || boost.size() > 9 ||
+            !std::all_of(boost.begin(), boost.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            return false;
+        }
+        parsed.boostPeriod = std::stoi(boost);
+    }
+    
+    std::stringstream ss(quanta);
+    std::string quantum;
+    while (std::getline(ss, quantum, '/')) {
+        if (quantum.empty() || quantum.size() > 9 ||
+            !std::all_of(quantum.begin(), quantum.end(), [](char c) { return c >= '0' && c <= '9'; }) ||
+            std::stoi(quantum) <= 0) {
+            return false;
+        }
+        parsed.quanta.push_back(std::stoi(quantum));
+    }
+    if (parsed.quanta.empty() || parsed.quanta.size() > 64 || quanta.back() == '/') {
+        return false;
+    }
+    
+    settings = parsed;
+    return true;
 }
 
-int RRScheduler::getTimeSlice() const {
-    return timeQuantum;
+bool parseFairAlgorithm(const std::string& algorithm, FairSettings& settings) {
+    if (algorithm.compare(0, 3, "CFS") != 0) {
+        return false;
+    }
+    if (algorithm.size() == 3) {
+        settings = FairSettings();
+        return true;
+    }
+    
+    // "CFS:<latency>/<granularity>", both positive
+    std::size_t slash = algorithm.find('/');
+    if (algorithm[3] != ':' || slash == std::string::npos) {
+        return false;
+    }
+    std::string latency = algorithm.substr(4, slash - 4);
+    std::string granularity = algorithm.substr(slash + 1);
+    auto isNumber = [](const std::string& text) {
+        return !text.empty() && text.size() <= 9 &&
+               std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+    };
+    if (!isNumber(latency) || !isNumber(granularity) || std::stoi(latency) <= 0 ||
+        std::stoi(granularity) <= 0) {
+        return false;
+    }
+    
+    settings.targetLatency = std::stoi(latency);
+    settings.minGranularity = std::stoi(granularity);
+    return true;
 }
 
 // Factory function implementation
-std::shared_ptr<Scheduler> createScheduler(const std::string& algorithm, int processSwitchTime) {
+std::shared_ptr<Scheduler> createScheduler(const std::string& algorithm, int processSwitchTime,
+                                           std::pmr::memory_resource* memory) {
+    MLFQSettings mlfqSettings;
+    FairSettings fairSettings;
     if (algorithm == "FCFS") {
-        return std::make_shared<FCFSScheduler>(processSwitchTime);
+        return std::make_shared<FCFSScheduler>(processSwitchTime, memory);
     } else if (algorithm == "SJF") {
-        return std::make_shared<SJFScheduler>(processSwitchTime);
+        return std::make_shared<SJFScheduler>(processSwitchTime, memory);
     } else if (algorithm == "SRTN") {
-        return std::make_shared<SRTNScheduler>(processSwitchTime);
-    } else if (algorithm == "RR10") {
-        return std::make_shared<RRScheduler>(processSwitchTime, 10);
-    } else if (algorithm == "RR50") {
-        return std::make_shared<RRScheduler>(processSwitchTime, 50);
-    } else if (algorithm == "RR100") {
-        return std::make_shared<RRScheduler>(processSwitchTime, 100);
+        return std::make_shared<SRTNScheduler>(processSwitchTime, memory);
+    } else if (isRoundRobinAlgorithm(algorithm)) {
+        // RR<quantum>, e.g. RR10
+        return std::make_shared<RRScheduler>(processSwitchTime, std::stoi(algorithm.substr(2)), memory);
+    } else if (parseMLFQAlgorithm(algorithm, mlfqSettings)) {
+        return std::make_shared<MLFQScheduler>(processSwitchTime, mlfqSettings, memory);
+    } else if (parseFairAlgorithm(algorithm, fairSettings)) {
+        return std::make_shared<FairScheduler>(processSwitchTime, fairSettings, memory);
     } else {
         // Default to FCFS
-        return std::make_shared<FCFSScheduler>(processSwitchTime);
+        return std::make_shared<FCFSScheduler>(processSwitchTime, memory);
+    }
+}
+
+SchedulerPolicy createSchedulerPolicy(const std::string& algorithm, int processSwitchTime,
+                                      std::pmr::memory_resource* memory) {
+    MLFQSettings mlfqSettings;
+    FairSettings fairSettings;
+    if (algorithm == "SJF") {
+        return SJFScheduler(processSwitchTime, memory);
+    } else if (algorithm == "SRTN") {
+        return SRTNScheduler(processSwitchTime, memory);
+    } else if (isRoundRobinAlgorithm(algorithm)) {
+        return RRScheduler(processSwitchTime, std::stoi(algorithm.substr(2)), memory);
+    } else if (parseMLFQAlgorithm(algorithm, mlfqSettings)) {
+        return MLFQScheduler(processSwitchTime, mlfqSettings, memory);
+    } else if (parseFairAlgorithm(algorithm, fairSettings)) {
+        return FairScheduler(processSwitchTime, fairSettings, memory);
+    } else {
+        // FCFS, also the default
+        return FCFSScheduler(processSwitchTime, memory);
     }
-}
\ No newline at end of file
+}
@@ -1,17 +1,26 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
+#include <algorithm>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <vector>
 #include <queue>
+#include <set>
+#include <variant>
+#include "indexed_heap.h"
 #include "process.h"
+#include "snapshot.h"
 
 class Scheduler {
 protected:
     std::string name;
     int processSwitchTime;
     int timeQuantum; // Used for Round Robin
+    ProcessTable* processTable; // Process state of the current run; schedulers only write their own columns
     
 public:
     Scheduler(const std::string& name, int processSwitchTime);
@@ -19,97 +28,512 @@ public:
     
     std::string getName() const;
     int getProcessSwitchTime() const;
+    void setProcessTable(ProcessTable* table);
     
     // Pure virtual methods to be implemented by derived classes
-    virtual void addProcess(std::shared_ptr<Process> process) = 0;
-    virtual std::shared_ptr<Process> getNextProcess() = 0;
+    virtual void addProcess(ProcessHandle process) = 0;
+    virtual ProcessHandle getNextProcess(int currentTime) = 0;
     virtual bool hasProcesses() const = 0;
-    virtual bool shouldPreempt(std::shared_ptr<Process> runningProcess, 
-                              std::shared_ptr<Process> newProcess, int currentTime) = 0;
-    virtual int getTimeSlice() const = 0;
+    virtual std::size_t getReadyCount() const = 0;
+    virtual bool shouldPreempt(ProcessHandle runningProcess, 
+                              ProcessHandle newProcess, int currentTime) = 0;
+    virtual int getTimeSlice(ProcessHandle process) const = 0;
+    
+    // Called when a process used its whole time slice, before it is re-added
+    virtual void timeSliceExpired(ProcessHandle) {}
+    
+    // Checkpointing of the run queue and per-process state. Settings are not
+    // saved; restore expects a fresh scheduler built the same way, after the
+    // process table has been restored.
+    virtual void save(SnapshotWriter& out) const = 0;
+    virtual void restore(SnapshotReader& in) = 0;
 };
 
-class FCFSScheduler : public Scheduler {
+class FCFSScheduler final : public Scheduler {
 private:
-    std::queue<std::shared_ptr<Process>> readyQueue;
+    std::queue<ProcessHandle, std::pmr::deque<ProcessHandle>> readyQueue;
     
 public:
-    FCFSScheduler(int processSwitchTime);
+    explicit FCFSScheduler(int processSwitchTime, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
     
-    void addProcess(std::shared_ptr<Process> process) override;
-    std::shared_ptr<Process> getNextProcess() override;
+    void addProcess(ProcessHandle process) override;
+    ProcessHandle getNextProcess(int currentTime) override;
     bool hasProcesses() const override;
-    bool shouldPreempt(std::shared_ptr<Process> runningProcess, 
-                       std::shared_ptr<Process> newProcess, int currentTime) override;
-    int getTimeSlice() const override;
+    std::size_t getReadyCount() const override;
+    bool shouldPreempt(ProcessHandle runningProcess, 
+                       ProcessHandle newProcess, int currentTime) override;
+    int getTimeSlice(ProcessHandle process) const override;
+    void save(SnapshotWriter& out) const override;
+    void restore(SnapshotReader& in) override;
 };
 
-class SJFScheduler : public Scheduler {
+class SJFScheduler final : public Scheduler {
 private:
-    // Custom comparator for the priority queue
-    struct ProcessComparator {
-        bool operator()(const std::shared_ptr<Process>& p1, 
-                        const std::shared_ptr<Process>& p2) const {
-            return p1->getRemainingTimeInBurst() > p2->getRemainingTimeInBurst();
-        }
-    };
+    // Ready processes keyed by their remaining burst time when queued; the key
+    // is stored in the heap so comparisons don't touch the process table
+    IndexedHeap<int> readyQueue;
     
-    std::priority_queue<std::shared_ptr<Process>, 
-                        std::vector<std::shared_ptr<Process>>, 
-                        ProcessComparator> readyQueue;
+public:
+    explicit SJFScheduler(int processSwitchTime, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    
+    void addProcess(ProcessHandle process) override;
+    ProcessHandle getNextProcess(int currentTime) override;
+    bool hasProcesses() const override;
+    std::size_t getReadyCount() const override;
+    bool shouldPreempt(ProcessHandle runningProcess, 
+                       ProcessHandle newProcess, int currentTime) override;
+    int getTimeSlice(ProcessHandle process) const override;
+    void save(SnapshotWriter& out) const override;
+    void restore(SnapshotReader& in) override;
+};
+
+class SRTNScheduler final : public Scheduler {
+private:
+    // Ready processes keyed by their remaining burst time when queued; the key
+    // is stored in the heap so comparisons don't touch the process table
+    IndexedHeap<int> readyQueue;
     
 public:
-    SJFScheduler(int processSwitchTime);
+    explicit SRTNScheduler(int processSwitchTime, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
     
-    void addProcess(std::shared_ptr<Process> process) override;
-    std::shared_ptr<Process> getNextProcess() override;
+    void addProcess(ProcessHandle process) override;
+    ProcessHandle getNextProcess(int currentTime) override;
     bool hasProcesses() const override;
-    bool shouldPreempt(std::shared_ptr<Process> runningProcess, 
-                       std::shared_ptr<Process> newProcess, int currentTime) override;
-    int getTimeSlice() const override;
+    std::size_t getReadyCount() const override;
+    bool shouldPreempt(ProcessHandle runningProcess, 
+                       ProcessHandle newProcess, int currentTime) override;
+    int getTimeSlice(ProcessHandle process) const override;
+    void save(SnapshotWriter& out) const override;
+    void restore(SnapshotReader& in) override;
 };
 
-class SRTNScheduler : public Scheduler {
+class RRScheduler final : public Scheduler {
 private:
-    // Custom comparator for the priority queue
-    struct ProcessComparator {
-        bool operator()(const std::shared_ptr<Process>& p1, 
-                        const std::shared_ptr<Process>& p2) const {
-            return p1->getRemainingTimeInBurst() > p2->getRemainingTimeInBurst();
-        }
-    };
+    std::queue<ProcessHandle, std::pmr::deque<ProcessHandle>> readyQueue;
+    
+public:
+    RRScheduler(int processSwitchTime, int timeQuantum, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    
+    void addProcess(ProcessHandle process) override;
+    ProcessHandle getNextProcess(int currentTime) override;
+    bool hasProcesses() const override;
+    std::size_t getReadyCount() const override;
+    bool shouldPreempt(ProcessHandle runningProcess, 
+                       ProcessHandle newProcess, int currentTime) override;
+    int getTimeSlice(ProcessHandle process) const override;
+    void save(SnapshotWriter& out) const override;
+    void restore(SnapshotReader& in) override;
+};
+
+// Settings of MLFQScheduler, written "MLFQ[:q0/q1/.../qn[:boost]]": the time
+// quantum of each level from the highest priority down and the period of
+// priority boosts (0 disables them)
+struct MLFQSettings {
+    std::vector<int> quanta;
+    int boostPeriod;
+    
+    MLFQSettings() : quanta{10, 20, 40}, boostPeriod(1000) {}
+};
+
+// Multilevel feedback queue. New processes start at level 0; a process that
+// uses its whole slice drops one level, and every boostPeriod time units all
+// processes return to level 0. The highest non-empty level is found with a
+// find-first-set on a bitmap, so picking the next process is O(1).
+class MLFQScheduler final : public Scheduler {
+private:
+    static constexpr std::size_t MAX_LEVELS = 64;
     
-    std::priority_queue<std::shared_ptr<Process>, 
-                        std::vector<std::shared_ptr<Process>>, 
-                        ProcessComparator> readyQueue;
+    std::vector<int> quanta;
+    int boostPeriod;
+    int nextBoost;
+    std::pmr::vector<std::pmr::deque<ProcessHandle>> levels;
+    std::uint64_t nonEmptyLevels;   // Bit i is set while levels[i] has processes
+    std::size_t readyCount;
+    
+    // Boost period of the last boost. Levels live in the process table so they
+    // follow processes across cores; one set before this core's last boost
+    // reads as level 0, so a boost resets processes that are not queued in O(1).
+    std::uint32_t boostEpoch;
+    
+    int levelOf(ProcessHandle process) const;
+    void setLevel(ProcessHandle process, int level);
+    void boost(int currentTime);
     
 public:
-    SRTNScheduler(int processSwitchTime);
+    MLFQScheduler(int processSwitchTime, const MLFQSettings& settings, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
     
-    void addProcess(std::shared_ptr<Process> process) override;
-    std::shared_ptr<Process> getNextProcess() override;
+    void addProcess(ProcessHandle process) override;
+    ProcessHandle getNextProcess(int currentTime) override;
     bool hasProcesses() const override;
-    bool shouldPreempt(std::shared_ptr<Process> runningProcess, 
-                       std::shared_ptr<Process> newProcess, int currentTime) override;
-    int getTimeSlice() const override;
+    std::size_t getReadyCount() const override;
+    bool shouldPreempt(ProcessHandle runningProcess, 
+                       ProcessHandle newProcess, int currentTime) override;
+    int getTimeSlice(ProcessHandle process) const override;
+    void save(SnapshotWriter& out) const override;
+    void restore(SnapshotReader& in) override;
+    void timeSliceExpired(ProcessHandle process) override;
+};
+
+// Settings of FairScheduler, written "CFS[:latency/granularity]": the period
+// in which every runnable process should get to run once, and the shortest
+// slice handed out however many processes are runnable
+struct FairSettings {
+    int targetLatency;
+    int minGranularity;
+    
+    FairSettings() : targetLatency(48), minGranularity(6) {}
 };
 
-class RRScheduler : public Scheduler {
+// Weight of a nice value, as in Linux (nice 0 = 1024, each step about 10% CPU)
+int niceToWeight(int nice);
+
+// Weighted fair scheduler after Linux CFS. Each process accumulates virtual
+// runtime at a rate inversely proportional to its weight; the process with
+// the smallest vruntime runs next, for a slice of the scheduling period
+// proportional to its share of the runnable weight. The runnable set is a
+// red-black tree (std::set) whose leftmost node is cached by the container,
+// so pick-next is O(1) and re-insertion O(log n).
+class FairScheduler final : public Scheduler {
 private:
-    std::queue<std::shared_ptr<Process>> readyQueue;
+    // vruntime is kept in 1/1024 time units so small weighted slices don't round to 0
+    static constexpr std::uint64_t VRUNTIME_SCALE = 1024;
+    static constexpr std::uint64_t NICE_0_WEIGHT = 1024;
+    
+    struct RunnableEntry {
+        std::uint64_t vruntime;
+        std::uint64_t sequence;     // Insertion order, breaks vruntime ties
+        ProcessHandle process;
+        
+        bool operator<(const RunnableEntry& other) const {
+            if (vruntime != other.vruntime) {
+                return vruntime < other.vruntime;
+            }
+            return sequence < other.sequence;
+        }
+    };
+    
+    std::pmr::set<RunnableEntry> runnable;
+    int targetLatency;
+    int minGranularity;
+    std::uint64_t minVruntime;      // Monotonic floor for new and waking processes
+    std::uint64_t runnableWeight;
+    std::uint64_t nextSequence;
+    
+    std::uint64_t weightOf(ProcessHandle process) const {
+        return static_cast<std::uint64_t>(niceToWeight(processTable->getNice(process)));
+    }
     
 public:
-    RRScheduler(int processSwitchTime, int timeQuantum);
+    FairScheduler(int processSwitchTime, const FairSettings& settings, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
     
-    void addProcess(std::shared_ptr<Process> process) override;
-    std::shared_ptr<Process> getNextProcess() override;
+    void addProcess(ProcessHandle process) override;
+    ProcessHandle getNextProcess(int currentTime) override;
     bool hasProcesses() const override;
-    bool shouldPreempt(std::shared_ptr<Process> runningProcess, 
-                       std::shared_ptr<Process> newProcess, int currentTime) override;
-    int getTimeSlice() const override;
+    std::size_t getReadyCount() const override;
+    bool shouldPreempt(ProcessHandle runningProcess, 
+                       ProcessHandle newProcess, int currentTime) override;
+    int getTimeSlice(ProcessHandle process) const override;
+    void save(SnapshotWriter& out) const override;
+    void restore(SnapshotReader& in) override;
 };
 
-// Factory function to create schedulers based on algorithm name
-std::shared_ptr<Scheduler> createScheduler(const std::string& algorithm, int processSwitchTime);
+// Queue operations are defined inline so that Simulator<Policy> instantiated on
+// a concrete (final) scheduler can inline them into the event handlers
+
+// FCFS Scheduler
+inline void FCFSScheduler::addProcess(ProcessHandle process) {
+    readyQueue.push(process);
+}
+
+inline ProcessHandle FCFSScheduler::getNextProcess(int) {
+    if (readyQueue.empty()) {
+        return NO_PROCESS;
+    }
+    
+    ProcessHandle next = readyQueue.front();
+    readyQueue.pop();
+    return next;
+}
+
+inline bool FCFSScheduler::hasProcesses() const {
+    return !readyQueue.empty();
+}
+
+inline std::size_t FCFSScheduler::getReadyCount() const {
+    return readyQueue.size();
+}
+
+inline bool FCFSScheduler::shouldPreempt(ProcessHandle, ProcessHandle, int) {
+    // FCFS is non-preemptive
+    return false;
+}
+
+inline int FCFSScheduler::getTimeSlice(ProcessHandle) const {
+    // FCFS doesn't use time slices
+    return -1;
+}
+
+// SJF Scheduler
+inline void SJFScheduler::addProcess(ProcessHandle process) {
+    // A process that is queued already is re-keyed in place rather than queued twice
+    int remainingTime = processTable->getRemainingTimeInBurst(process);
+    if (!readyQueue.contains(process)) {
+        readyQueue.push(process, remainingTime);
+    } else if (remainingTime < readyQueue.keyOf(process)) {
+        readyQueue.decreaseKey(process, remainingTime);
+    } else {
+        readyQueue.updateKey(process, remainingTime);
+    }
+}
+
+inline ProcessHandle SJFScheduler::getNextProcess(int) {
+    if (readyQueue.empty()) {
+        return NO_PROCESS;
+    }
+    
+    return readyQueue.pop();
+}
+
+inline bool SJFScheduler::hasProcesses() const {
+    return !readyQueue.empty();
+}
+
+inline std::size_t SJFScheduler::getReadyCount() const {
+    return readyQueue.size();
+}
+
+inline bool SJFScheduler::shouldPreempt(ProcessHandle, ProcessHandle, int) {
+    // SJF is non-preemptive
+    return false;
+}
+
+inline int SJFScheduler::getTimeSlice(ProcessHandle) const {
+    // SJF doesn't use time slices
+    return -1;
+}
+
+// SRTN Scheduler
+inline void SRTNScheduler::addProcess(ProcessHandle process) {
+    // A process that is queued already is re-keyed in place rather than queued twice
+    int remainingTime = processTable->getRemainingTimeInBurst(process);
+    if (!readyQueue.contains(process)) {
+        readyQueue.push(process, remainingTime);
+    } else if (remainingTime < readyQueue.keyOf(process)) {
+        readyQueue.decreaseKey(process, remainingTime);
+    } else {
+        readyQueue.updateKey(process, remainingTime);
+    }
+}
+
+inline ProcessHandle SRTNScheduler::getNextProcess(int) {
+    if (readyQueue.empty()) {
+        return NO_PROCESS;
+    }
+    
+    return readyQueue.pop();
+}
+
+inline bool SRTNScheduler::hasProcesses() const {
+    return !readyQueue.empty();
+}
+
+inline std::size_t SRTNScheduler::getReadyCount() const {
+    return readyQueue.size();
+}
+
+inline bool SRTNScheduler::shouldPreempt(ProcessHandle runningProcess, 
+                                         ProcessHandle newProcess, int currentTime) {
+    // Preempt if the new process has a shorter remaining time than what is
+    // left of the running one's burst
+    return processTable->getRemainingTimeInBurst(newProcess) < 
+           processTable->getRemainingTimeAt(runningProcess, currentTime);
+}
+
+inline int SRTNScheduler::getTimeSlice(ProcessHandle) const {
+    // SRTN doesn't use time slices
+    return -1;
+}
+
+// RR Scheduler
+inline void RRScheduler::addProcess(ProcessHandle process) {
+    readyQueue.push(process);
+}
+
+inline ProcessHandle RRScheduler::getNextProcess(int) {
+    if (readyQueue.empty()) {
+        return NO_PROCESS;
+    }
+    
+    ProcessHandle next = readyQueue.front();
+    readyQueue.pop();
+    return next;
+}
+
+inline bool RRScheduler::hasProcesses() const {
+    return !readyQueue.empty();
+}
+
+inline std::size_t RRScheduler::getReadyCount() const {
+    return readyQueue.size();
+}
+
+inline bool RRScheduler::shouldPreempt(ProcessHandle, ProcessHandle, int) {
+    // Round Robin preempts based on time slice, not on process arrival
+    return false;
+}
+
+inline int RRScheduler::getTimeSlice(ProcessHandle) const {
+    return timeQuantum;
+}
+
+// MLFQ Scheduler
+inline int MLFQScheduler::levelOf(ProcessHandle process) const {
+    // New processes start at level 0, as the table resets it for every process.
+    // A level set on another core stays valid until this core has boosted past it.
+    return processTable->getLevelEpoch(process) >= boostEpoch ? processTable->getLevel(process) : 0;
+}
+
+inline void MLFQScheduler::setLevel(ProcessHandle process, int level) {
+    // Never stamp an older epoch than the process already carries from another core
+    processTable->setLevel(process, level, std::max(boostEpoch, processTable->getLevelEpoch(process)));
+}
+
+inline void MLFQScheduler::addProcess(ProcessHandle process) {
+    int level = levelOf(process);
+    levels[level].push_back(process);
+    nonEmptyLevels |= std::uint64_t(1) << level;
+    readyCount++;
+}
+
+inline ProcessHandle MLFQScheduler::getNextProcess(int currentTime) {
+    if (boostPeriod > 0 && currentTime >= nextBoost) {
+        boost(currentTime);
+        nextBoost = (currentTime / boostPeriod + 1) * boostPeriod;
+    }
+    
+    if (nonEmptyLevels == 0) {
+        return NO_PROCESS;
+    }
+    
+    int level = __builtin_ctzll(nonEmptyLevels);
+    ProcessHandle next = levels[level].front();
+    levels[level].pop_front();
+    if (levels[level].empty()) {
+        nonEmptyLevels &= ~(std::uint64_t(1) << level);
+    }
+    readyCount--;
+    return next;
+}
+
+inline bool MLFQScheduler::hasProcesses() const {
+    return readyCount > 0;
+}
+
+inline std::size_t MLFQScheduler::getReadyCount() const {
+    return readyCount;
+}
+
+inline bool MLFQScheduler::shouldPreempt(ProcessHandle, ProcessHandle, int) {
+    // Levels are only re-evaluated at the end of a slice
+    return false;
+}
+
+inline int MLFQScheduler::getTimeSlice(ProcessHandle process) const {
+    return quanta[levelOf(process)];
+}
+
+inline void MLFQScheduler::timeSliceExpired(ProcessHandle process) {
+    int lowest = static_cast<int>(quanta.size()) - 1;
+    setLevel(process, std::min(levelOf(process) + 1, lowest));
+}
+
+// Fair Scheduler
+inline void FairScheduler::addProcess(ProcessHandle process) {
+    // vruntime is kept in the process table, so it follows the process across cores
+    std::uint64_t weight = weightOf(process);
+    std::uint64_t vruntime = processTable->getVruntime(process);
+    int service = processTable->getServiceTime(process);
+    if (processTable->getStartTime(process) < 0) {
+        // New process: start level with the runnable set
+        vruntime = minVruntime;
+    } else {
+        // Charge the CPU time used since the process was last queued
+        std::uint64_t used = static_cast<std::uint64_t>(service - processTable->getAccountedService(process));
+        vruntime += used * VRUNTIME_SCALE * NICE_0_WEIGHT / weight;
+        
+        // Processes waking from I/O get at most half a period of credit
+        std::uint64_t credit = static_cast<std::uint64_t>(targetLatency) * VRUNTIME_SCALE / 2;
+        if (minVruntime > credit) {
+            vruntime = std::max(vruntime, minVruntime - credit);
+        }
+    }
+    processTable->setVruntime(process, vruntime, service);
+    
+    runnable.insert(RunnableEntry{vruntime, nextSequence++, process});
+    runnableWeight += weight;
+}
+
+inline ProcessHandle FairScheduler::getNextProcess(int) {
+    if (runnable.empty()) {
+        return NO_PROCESS;
+    }
+    
+    auto leftmost = runnable.begin();
+    ProcessHandle next = leftmost->process;
+    minVruntime = std::max(minVruntime, leftmost->vruntime);
+    runnable.erase(leftmost);
+    runnableWeight -= weightOf(next);
+    return next;
+}
+
+inline bool FairScheduler::hasProcesses() const {
+    return !runnable.empty();
+}
+
+inline std::size_t FairScheduler::getReadyCount() const {
+    return runnable.size();
+}
+
+inline bool FairScheduler::shouldPreempt(ProcessHandle, ProcessHandle, int) {
+    // Fairness is restored at the end of each slice
+    return false;
+}
+
+inline int FairScheduler::getTimeSlice(ProcessHandle process) const {
+    // The period stretches once there are too many processes to give each the
+    // minimum granularity within the target latency
+    std::uint64_t running = runnable.size() + 1;
+    std::uint64_t period = static_cast<std::uint64_t>(targetLatency);
+    if (running * minGranularity > period) {
+        period = running * minGranularity;
+    }
+    
+    std::uint64_t weight = weightOf(process);
+    std::uint64_t slice = period * weight / (runnableWeight + weight);
+    return static_cast<int>(std::max<std::uint64_t>(slice, minGranularity));
+}
+
+// True for "RR<quantum>" names with a positive quantum, e.g. RR10
+bool isRoundRobinAlgorithm(const std::string& algorithm);
+
+// Parses "MLFQ[:q0/q1/.../qn[:boost]]"; false if the name is not a valid MLFQ
+bool parseMLFQAlgorithm(const std::string& algorithm, MLFQSettings& settings);
+
+// Parses "CFS[:latency/granularity]"; false if the name is not a valid CFS
+bool parseFairAlgorithm(const std::string& algorithm, FairSettings& settings);
+
+// Factory function to create schedulers based on algorithm name. The run
+// queues allocate from memory, usually the arena of the run.
+std::shared_ptr<Scheduler> createScheduler(const std::string& algorithm, int processSwitchTime,
+                                           std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+// Concrete scheduler chosen at run time, for running Simulator<Policy> on the
+// alternative's own type through std::visit
+using SchedulerPolicy = std::variant<FCFSScheduler, SJFScheduler, SRTNScheduler, RRScheduler,
+                                     MLFQScheduler, FairScheduler>;
+
+// Same selection rules as createScheduler
+SchedulerPolicy createSchedulerPolicy(const std::string& algorithm, int processSwitchTime,
+                                      std::pmr::memory_resource* memory = std::pmr::get_default_resource());
 
 #endif // SCHEDULER_H
\ No newline at end of file
@@ -1,33 +1,127 @@
 #include "simulator.h"
-#include <iostream>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "snapshot.h"
 
-Simulator::Simulator(bool verboseMode, bool detailedMode, std::shared_ptr<Scheduler> scheduler)
-    : verboseMode(verboseMode), detailedMode(detailedMode), currentTime(0), 
-      scheduler(scheduler), runningProcess(nullptr) {
+namespace {
+
+const char CHECKPOINT_MAGIC[8] = {'C', 'P', 'U', 'S', 'I', 'M', 'C', 'K'};
+const std::uint32_t CHECKPOINT_VERSION = 3;
+
+// First checkpoint time after time
+long long nextCheckpointAfter(int time, int interval) {
+    return (static_cast<long long>(time) / interval + 1) * interval;
 }
 
-void Simulator::addProcess(std::shared_ptr<Process> process) {
-    processes.push_back(process);
-    stats.addProcess(process);
-    
-    // Schedule process arrival event
-    eventQueue.addEvent(Event(EventType::PROCESS_ARRIVAL, process->getArrivalTime(), process));
+} // namespace
+
+template <typename Policy>
+Simulator<Policy>::Simulator(const SimulationOptions& options,
+                             std::vector<std::shared_ptr<Policy>> schedulers,
+                             ArrivalSource& arrivals, std::ostream& traceStream,
+                             std::pmr::memory_resource* memory)
+    : verboseMode(options.verboseMode), detailedMode(options.detailedMode), traceStream(traceStream),
+      transitionLog(nullptr), currentEvent(EventType::PROCESS_ARRIVAL), timeline(nullptr), currentTime(0), eventQueue(options.eventQueue, memory), arrivals(arrivals),
+      migrationCost(options.migrationCost), processes(memory), blockedProcesses(memory),
+      deviceSettings(options.ioDevices), stats(memory),
+      eventCount(0), checkpointInterval(options.checkpointInterval),
+      checkpointFile(options.checkpointFile), nextCheckpoint(options.checkpointInterval), restored(false) {
+    for (const auto& scheduler : schedulers) {
+        scheduler->setProcessTable(&processes);
+        cores.push_back(Core{scheduler, NO_PROCESS, false});
+    }
+    for (const IoDeviceSettings& settings : deviceSettings) {
+        devices.emplace_back(settings, memory);
+        stats.addDevice(settings.capacity);
+    }
+    stats.setRecordProcesses(detailedMode);
+    stats.setCoreCount(static_cast<int>(cores.size()));
+}
+
+template <typename Policy>
+void Simulator<Policy>::admitNextArrival() {
+    // Only the next arrival is queued; the one after it is admitted when it fires
+    ProcessHandle process = arrivals.admitNext(processes);
+    if (process != NO_PROCESS) {
+        eventQueue.addEvent(Event(EventType::PROCESS_ARRIVAL, processes.getArrivalTime(process), process));
+    }
+}
+
+template <typename Policy>
+void Simulator<Policy>::terminateProcess(ProcessHandle process) {
+    // Fold the finished process into the statistics and free its slot
+    stats.addProcess(processes, process);
+    processes.release(process);
 }
 
-void Simulator::run() {
+template <typename Policy>
+bool Simulator<Policy>::run() {
+    // A restored run already has its next arrival queued
+    if (!restored) {
+        admitNextArrival();
+    } else if (timeline) {
+        // Runs in progress at the checkpoint show from where the run resumes
+        for (std::size_t i = 0; i < cores.size(); i++) {
+            if (cores[i].runningProcess != NO_PROCESS) {
+                timeline->runStarted(static_cast<int>(i), currentTime);
+            }
+        }
+    }
+    
     while (eventQueue.hasEvents()) {
         Event event = eventQueue.getNextEvent();
+        if (isStale(event)) {
+            continue;
+        }
+        SIM_COUNT_EVENT(instrumentation, event.getType(), eventQueue.size(), countReadyProcesses());
         currentTime = event.getTime();
         processEvent(event);
+        eventCount++;
+        
+        if (checkpointInterval > 0 && currentTime >= nextCheckpoint && !checkpoint()) {
+            return false;
+        }
     }
     
     // Set final statistics
     stats.setTotalTime(currentTime);
+    
+    // Report processes that never finished as well
+    for (ProcessHandle process = 0; process < processes.size(); process++) {
+        if (processes.getState(process) != ProcessState::TERMINATED) {
+            stats.addProcess(processes, process);
+        }
+    }
+    stats.sortProcesses();
+#ifdef SIM_INSTRUMENT
+    stats.setInstrumentation(instrumentation);
+#endif
+    return true;
 }
 
-void Simulator::processEvent(const Event& event) {
-    std::shared_ptr<Process> process = event.getProcess();
+template <typename Policy>
+bool Simulator<Policy>::isStale(const Event& event) const {
+    // Preemption leaves the end of the interrupted run queued; it is only live
+    // while it still matches the run the process is in
+    EventType type = event.getType();
+    if (type != EventType::CPU_BURST_COMPLETION && type != EventType::TIME_SLICE_EXPIRED) {
+        return false;
+    }
+    ProcessHandle process = event.getProcess();
+    bool sliceEnds = processes.getRemainingTimeInBurst(process) > 0;
+    return processes.getState(process) != ProcessState::RUNNING ||
+           processes.getRunEnd(process) != event.getTime() ||
+           sliceEnds != (type == EventType::TIME_SLICE_EXPIRED);
+}
+
+template <typename Policy>
+void Simulator<Policy>::processEvent(const Event& event) {
+    ProcessHandle process = event.getProcess();
+    currentEvent = event.getType();
+    SIM_TIME_HANDLER(instrumentation, event.getType());
     
     switch (event.getType()) {
         case EventType::PROCESS_ARRIVAL:
@@ -47,184 +141,517 @@ void Simulator::processEvent(const Event& event) {
             break;
             
         case EventType::PROCESS_PREEMPTED:
-            // Process was preempted, move to ready queue
-            ProcessState oldState = process->getState();
-            process->setState(ProcessState::READY);
-            if (verboseMode) {
-                printStateTransition(process, oldState, ProcessState::READY);
-            }
-            scheduler->addProcess(process);
-            runningProcess = nullptr;
-            scheduleNextProcess();
+            handleProcessPreempted(process);
             break;
     }
 }
 
-void Simulator::handleProcessArrival(std::shared_ptr<Process> process) {
-    // Change process state to ready
-    ProcessState oldState = process->getState();
-    process->setState(ProcessState::READY);
-    if (verboseMode) {
-        printStateTransition(process, oldState, ProcessState::READY);
-    }
-    
-    // If we have a preemptive scheduler, check if we should preempt the current process
-    if (runningProcess && scheduler->shouldPreempt(runningProcess, process, currentTime)) {
-        // Schedule preemption event
-        eventQueue.addEvent(Event(EventType::PROCESS_PREEMPTED, currentTime, runningProcess));
-    }
-    
-    // Add process to scheduler
-    scheduler->addProcess(process);
-    
-    // If no process is running, schedule the next one
-    if (!runningProcess) {
-        scheduleNextProcess();
+template <typename Policy>
+void Simulator<Policy>::handleProcessArrival(ProcessHandle process) {
+    // Every process arriving at this time is handled here as one batch, taken
+    // straight from the arrival source instead of through the event queue.
+    // Arrivals sort before all other events at the same time, so this is the
+    // order in which they would have been processed one by one.
+    while (process != NO_PROCESS) {
+        ProcessHandle next = arrivals.admitNext(processes);
+        if (next != NO_PROCESS && processes.getArrivalTime(next) != currentTime) {
+            eventQueue.addEvent(Event(EventType::PROCESS_ARRIVAL, processes.getArrivalTime(next), next));
+            next = NO_PROCESS;
+        }
+        
+        // Change process state to ready
+        ProcessState oldState = processes.getState(process);
+        processes.setState(process, ProcessState::READY);
+        processes.setReadySince(process, currentTime);
+        if (verboseMode) {
+            printStateTransition(process, oldState, ProcessState::READY);
+        }
+        if (timeline) {
+            timeline->processArrived(processes.getId(process), currentTime);
+        }
+        
+        // New processes go to the least loaded core
+        makeReady(process, selectCore());
+        
+        if (next != NO_PROCESS) {
+            SIM_COUNT_EVENT(instrumentation, EventType::PROCESS_ARRIVAL, eventQueue.size(),
+                            countReadyProcesses());
+            eventCount++;
+        }
+        process = next;
     }
 }
 
-void Simulator::handleCpuBurstCompletion(std::shared_ptr<Process> process) {
-    // Add CPU time to statistics
-    int burstTime = process->getRemainingTimeInBurst();
-    stats.addCpuBusyTime(burstTime);
-    process->addServiceTime(burstTime);
+template <typename Policy>
+void Simulator<Policy>::handleCpuBurstCompletion(ProcessHandle process) {
+    int core = processes.getCore(process);
+    if (timeline) {
+        timeline->runEnded(core, processes.getId(process), currentTime);
+    }
     
     // Move to next burst, which should be an I/O burst
-    process->moveToNextBurst();
+    processes.moveToNextBurst(process);
     
     // If process has more bursts, move to I/O; otherwise, terminate
-    if (process->hasMoreBursts()) {
-        ProcessState oldState = process->getState();
-        process->setState(ProcessState::BLOCKED);
+    if (processes.hasMoreBursts(process)) {
+        ProcessState oldState = processes.getState(process);
+        processes.setState(process, ProcessState::BLOCKED);
         if (verboseMode) {
             printStateTransition(process, oldState, ProcessState::BLOCKED);
         }
         
-        // Add process to blocked queue and schedule I/O completion
-        blockedProcesses[process->getId()] = process;
-        int ioCompletionTime = currentTime + process->getRemainingTimeInBurst();
-        eventQueue.addEvent(Event(EventType::IO_BURST_COMPLETION, ioCompletionTime, process));
+        // Add process to blocked queue and start its I/O, or queue it on a busy device
+        blockedProcesses.insert(process);
+        if (devices.empty()) {
+            int ioCompletionTime = currentTime + processes.getRemainingTimeInBurst(process);
+            if (timeline) {
+                timeline->io(processes.getId(process), -1, currentTime, ioCompletionTime);
+            }
+            eventQueue.addEvent(Event(EventType::IO_BURST_COMPLETION, ioCompletionTime, process));
+        } else {
+            int device = deviceOf(process);
+            IoDevice::Request request{process, ioTrack(processes.getId(process), processes.getCurrentBurst(process)),
+                                      currentTime};
+            if (devices[device].isFull()) {
+                devices[device].enqueue(request, processes.getIoTime(process));
+            } else {
+                startIo(device, request);
+            }
+        }
     } else {
         // Process has completed all bursts, terminate
-        ProcessState oldState = process->getState();
-        process->setState(ProcessState::TERMINATED);
+        ProcessState oldState = processes.getState(process);
+        processes.setState(process, ProcessState::TERMINATED);
         if (verboseMode) {
             printStateTransition(process, oldState, ProcessState::TERMINATED);
         }
-        process->setFinishTime(currentTime);
+        processes.setFinishTime(process, currentTime);
+        terminateProcess(process);
     }
     
-    // No process is running now
-    runningProcess = nullptr;
-    
-    // Schedule next process after process switch overhead
-    currentTime += scheduler->getProcessSwitchTime();
-    stats.addProcessSwitchTime(scheduler->getProcessSwitchTime());
-    scheduleNextProcess();
+    releaseCore(core);
 }
 
-void Simulator::handleIoBurstCompletion(std::shared_ptr<Process> process) {
+template <typename Policy>
+void Simulator<Policy>::handleIoBurstCompletion(ProcessHandle process) {
     // Add I/O time to statistics
-    int burstTime = process->getRemainingTimeInBurst();
-    process->addIoTime(burstTime);
+    int burstTime = processes.getRemainingTimeInBurst(process);
+    processes.addIoTime(process, burstTime);
     
-    // Remove process from blocked queue
-    blockedProcesses.erase(process->getId());
+    // Remove process from blocked queue and hand its channel to the next request
+    blockedProcesses.erase(process);
+    if (!devices.empty()) {
+        int device = deviceOf(process);
+        devices[device].finish();
+        if (devices[device].hasWaiting()) {
+            startIo(device, devices[device].takeNext());
+        }
+    }
     
     // Move to next burst, which should be a CPU burst
-    process->moveToNextBurst();
+    processes.moveToNextBurst(process);
     
     // Change process state to ready
-    ProcessState oldState = process->getState();
-    process->setState(ProcessState::READY);
+    ProcessState oldState = processes.getState(process);
+    processes.setState(process, ProcessState::READY);
+    processes.setReadySince(process, currentTime);
     if (verboseMode) {
         printStateTransition(process, oldState, ProcessState::READY);
     }
     
-    // If we have a preemptive scheduler, check if we should preempt the current process
-    if (runningProcess && scheduler->shouldPreempt(runningProcess, process, currentTime)) {
-        // Schedule preemption event
-        eventQueue.addEvent(Event(EventType::PROCESS_PREEMPTED, currentTime, runningProcess));
-    }
-    
-    // Add process to scheduler
-    scheduler->addProcess(process);
-    
-    // If no process is running, schedule the next one
-    if (!runningProcess) {
-        scheduleNextProcess();
+    // Return to the core the process last ran on to keep its cache warm
+    makeReady(process, processes.getCore(process));
+}
+
+template <typename Policy>
+int Simulator<Policy>::deviceOf(ProcessHandle process) const {
+    return static_cast<int>(static_cast<std::uint32_t>(processes.getId(process)) % devices.size());
+}
+
+template <typename Policy>
+void Simulator<Policy>::startIo(int device, const IoDevice::Request& request) {
+    devices[device].start(request);
+    int burstTime = processes.getRemainingTimeInBurst(request.process);
+    stats.addIoRequest(device, burstTime, currentTime - request.submitTime);
+    if (timeline) {
+        int id = processes.getId(request.process);
+        timeline->ioWait(id, device, request.submitTime, currentTime);
+        timeline->io(id, device, currentTime, currentTime + burstTime);
     }
+    eventQueue.addEvent(Event(EventType::IO_BURST_COMPLETION, currentTime + burstTime, request.process));
 }
 
-void Simulator::handleTimeSliceExpired(std::shared_ptr<Process> process) {
+template <typename Policy>
+void Simulator<Policy>::handleTimeSliceExpired(ProcessHandle process) {
+    int core = processes.getCore(process);
+    if (timeline) {
+        timeline->runEnded(core, processes.getId(process), currentTime);
+    }
+    
     // Process time slice has expired, move back to ready queue
-    ProcessState oldState = process->getState();
-    process->setState(ProcessState::READY);
+    ProcessState oldState = processes.getState(process);
+    processes.setState(process, ProcessState::READY);
+    processes.setReadySince(process, currentTime);
     if (verboseMode) {
         printStateTransition(process, oldState, ProcessState::READY);
     }
     
     // Add process back to scheduler
-    scheduler->addProcess(process);
+    cores[core].scheduler->timeSliceExpired(process);
+    SIM_COUNT_SCHEDULER_CALL(instrumentation, ADD_PROCESS);
+    cores[core].scheduler->addProcess(process);
+    
+    releaseCore(core);
+}
+
+template <typename Policy>
+void Simulator<Policy>::handleProcessPreempted(ProcessHandle process) {
+    int core = processes.getCore(process);
+    if (timeline) {
+        timeline->runEnded(core, processes.getId(process), currentTime);
+    }
+    
+    // Take back the CPU time it did not get to use. Its pending end of run
+    // stays queued and is dropped as stale when it comes up.
+    int unused = processes.preemptRun(process, currentTime);
+    stats.addCpuBusyTime(-unused);
+    stats.addCoreBusyTime(core, -unused);
+    
+    // Process was preempted, move to ready queue
+    ProcessState oldState = processes.getState(process);
+    processes.setState(process, ProcessState::READY);
+    processes.setReadySince(process, currentTime);
+    if (verboseMode) {
+        printStateTransition(process, oldState, ProcessState::READY);
+    }
+    SIM_COUNT_SCHEDULER_CALL(instrumentation, ADD_PROCESS);
+    cores[core].scheduler->addProcess(process);
+    cores[core].runningProcess = NO_PROCESS;
+    cores[core].preemptionPending = false;
+    scheduleNextProcess(core);
+}
+
+template <typename Policy>
+std::size_t Simulator<Policy>::countReadyProcesses() const {
+    std::size_t ready = 0;
+    for (const auto& core : cores) {
+        ready += core.scheduler->getReadyCount();
+    }
+    return ready;
+}
+
+template <typename Policy>
+int Simulator<Policy>::selectCore() const {
+    // Fewest queued plus running processes wins; ties go to the lowest core
+    int bestCore = 0;
+    std::size_t bestLoad = SIZE_MAX;
+    for (std::size_t i = 0; i < cores.size(); i++) {
+        SIM_COUNT_SCHEDULER_CALL(instrumentation, GET_READY_COUNT);
+        std::size_t load = cores[i].scheduler->getReadyCount()
+                         + (cores[i].runningProcess != NO_PROCESS ? 1 : 0);
+        if (load < bestLoad) {
+            bestLoad = load;
+            bestCore = static_cast<int>(i);
+        }
+    }
+    return bestCore;
+}
+
+template <typename Policy>
+void Simulator<Policy>::makeReady(ProcessHandle process, int core) {
+    Core& target = cores[core];
+    processes.setCore(process, core);
+    
+    // If we have a preemptive scheduler, check if we should preempt the current
+    // process; one decision per core stands until the preemption is handled
+    if (target.runningProcess != NO_PROCESS && !target.preemptionPending) {
+        SIM_COUNT_SCHEDULER_CALL(instrumentation, SHOULD_PREEMPT);
+        if (target.scheduler->shouldPreempt(target.runningProcess, process, currentTime)) {
+            // Schedule preemption event
+            eventQueue.addEvent(Event(EventType::PROCESS_PREEMPTED, currentTime, target.runningProcess));
+            target.preemptionPending = true;
+        }
+    }
+    
+    // Add process to scheduler
+    SIM_COUNT_SCHEDULER_CALL(instrumentation, ADD_PROCESS);
+    target.scheduler->addProcess(process);
     
+    // If no process is running, schedule the next one
+    if (target.runningProcess == NO_PROCESS) {
+        scheduleNextProcess(core);
+        return;
+    }
+    
+    // The target core is busy; let idle cores pull the new work over
+    for (std::size_t i = 0; i < cores.size(); i++) {
+        if (cores[i].runningProcess == NO_PROCESS) {
+            scheduleNextProcess(static_cast<int>(i));
+        }
+    }
+}
+
+template <typename Policy>
+void Simulator<Policy>::releaseCore(int core) {
     // No process is running now
-    runningProcess = nullptr;
+    cores[core].runningProcess = NO_PROCESS;
     
     // Schedule next process after process switch overhead
-    currentTime += scheduler->getProcessSwitchTime();
-    stats.addProcessSwitchTime(scheduler->getProcessSwitchTime());
-    scheduleNextProcess();
+    int processSwitchTime = cores[core].scheduler->getProcessSwitchTime();
+    if (timeline) {
+        timeline->processSwitch(core, currentTime, processSwitchTime);
+    }
+    currentTime += processSwitchTime;
+    stats.addProcessSwitchTime(processSwitchTime);
+    scheduleNextProcess(core);
+}
+
+template <typename Policy>
+ProcessHandle Simulator<Policy>::stealProcess(int core) {
+    // Take work from the core with the longest run queue
+    std::size_t victim = cores.size();
+    std::size_t longestQueue = 0;
+    for (std::size_t i = 0; i < cores.size(); i++) {
+        SIM_COUNT_SCHEDULER_CALL(instrumentation, GET_READY_COUNT);
+        std::size_t queued = cores[i].scheduler->getReadyCount();
+        if (static_cast<int>(i) != core && queued > longestQueue) {
+            longestQueue = queued;
+            victim = i;
+        }
+    }
+    if (victim == cores.size()) {
+        return NO_PROCESS;
+    }
+    SIM_COUNT_SCHEDULER_CALL(instrumentation, GET_NEXT_PROCESS);
+    return cores[victim].scheduler->getNextProcess(currentTime);
 }
 
-void Simulator::scheduleNextProcess() {
+template <typename Policy>
+void Simulator<Policy>::scheduleNextProcess(int core) {
+    Core& cpu = cores[core];
+    
     // If there's already a running process, do nothing
-    if (runningProcess) {
+    if (cpu.runningProcess != NO_PROCESS) {
         return;
     }
     
-    // Get next process from scheduler
-    if (scheduler->hasProcesses()) {
-        std::shared_ptr<Process> nextProcess = scheduler->getNextProcess();
-        
-        if (nextProcess) {
-            runningProcess = nextProcess;
-            
-            // Change process state to running
-            ProcessState oldState = runningProcess->getState();
-            runningProcess->setState(ProcessState::RUNNING);
-            if (verboseMode) {
-                printStateTransition(runningProcess, oldState, ProcessState::RUNNING);
-            }
-            
-            // Set start time if this is the first time the process runs
-            runningProcess->setStartTime(currentTime);
-            
-            // Schedule either burst completion or time slice expired
-            int timeSlice = scheduler->getTimeSlice();
-            int remainingTime = runningProcess->getRemainingTimeInBurst();
-            
-            if (timeSlice > 0 && remainingTime > timeSlice) {
-                // Round Robin: schedule time slice expiration
-                eventQueue.addEvent(Event(EventType::TIME_SLICE_EXPIRED, 
-                                        currentTime + timeSlice, runningProcess));
-                runningProcess->decrementRemainingTime(timeSlice);
-            } else {
-                // Schedule CPU burst completion
-                eventQueue.addEvent(Event(EventType::CPU_BURST_COMPLETION, 
-                                        currentTime + remainingTime, runningProcess));
-                runningProcess->setRemainingTimeInBurst(0);
-            }
+    // Prefer the core's own run queue, otherwise steal and pay for the migration
+    int startTime = currentTime;
+    SIM_COUNT_SCHEDULER_CALL(instrumentation, HAS_PROCESSES);
+    ProcessHandle nextProcess = NO_PROCESS;
+    if (cpu.scheduler->hasProcesses()) {
+        SIM_COUNT_SCHEDULER_CALL(instrumentation, GET_NEXT_PROCESS);
+        nextProcess = cpu.scheduler->getNextProcess(currentTime);
+    }
+    if (nextProcess == NO_PROCESS && cores.size() > 1) {
+        nextProcess = stealProcess(core);
+        if (nextProcess == NO_PROCESS) {
+            return;
         }
+        startTime += migrationCost;
+        stats.addMigration();
+    }
+    if (nextProcess == NO_PROCESS) {
+        return;
+    }
+    
+    cpu.runningProcess = nextProcess;
+    processes.setCore(nextProcess, core);
+    
+    // Change process state to running
+    ProcessState oldState = processes.getState(nextProcess);
+    processes.setState(nextProcess, ProcessState::RUNNING);
+    if (verboseMode) {
+        printStateTransition(nextProcess, oldState, ProcessState::RUNNING);
+    }
+    
+    // Set start time if this is the first time the process runs
+    processes.setStartTime(nextProcess, startTime);
+    processes.addWaitTime(nextProcess, startTime - processes.getReadySince(nextProcess));
+    if (timeline) {
+        int id = processes.getId(nextProcess);
+        timeline->ready(id, processes.getReadySince(nextProcess), startTime);
+        timeline->migration(core, id, currentTime, startTime);
+        timeline->runStarted(core, startTime);
+    }
+    
+    // Schedule either burst completion or time slice expired
+    SIM_COUNT_SCHEDULER_CALL(instrumentation, GET_TIME_SLICE);
+    int timeSlice = cpu.scheduler->getTimeSlice(nextProcess);
+    int remainingTime = processes.getRemainingTimeInBurst(nextProcess);
+    
+    if (timeSlice > 0 && remainingTime > timeSlice) {
+        // Round Robin: schedule time slice expiration
+        eventQueue.addEvent(Event(EventType::TIME_SLICE_EXPIRED, 
+                                startTime + timeSlice, nextProcess));
+        processes.setRun(nextProcess, startTime, startTime + timeSlice);
+        processes.decrementRemainingTime(nextProcess, timeSlice);
+        stats.addCpuBusyTime(timeSlice);
+        stats.addCoreBusyTime(core, timeSlice);
+    } else {
+        // Schedule CPU burst completion
+        eventQueue.addEvent(Event(EventType::CPU_BURST_COMPLETION, 
+                                startTime + remainingTime, nextProcess));
+        processes.setRun(nextProcess, startTime, startTime + remainingTime);
+        processes.setRemainingTimeInBurst(nextProcess, 0);
+        stats.addCpuBusyTime(remainingTime);
+        stats.addCoreBusyTime(core, remainingTime);
     }
 }
 
-void Simulator::printStateTransition(std::shared_ptr<Process> process, 
+template <typename Policy>
+void Simulator<Policy>::printStateTransition(ProcessHandle process, 
                                     ProcessState oldState, ProcessState newState) {
-    std::cout << "At time " << currentTime << ": Process " << process->getId() 
-              << " moves from " << process->stateToString() << " to " 
-              << process->stateToString() << "\n";
+    if (transitionLog) {
+        transitionLog->append(TransitionRecord{currentTime, processes.getId(process), oldState, newState,
+                                               currentEvent, 0});
+        return;
+    }
+    
+    traceStream << "At time " << currentTime << ": Process " << processes.getId(process) 
+              << " moves from " << processStateToString(oldState) << " to " 
+              << processStateToString(newState) << "\n";
 }
 
-Statistics Simulator::getStatistics() const {
+template <typename Policy>
+Statistics Simulator<Policy>::getStatistics() const {
     return stats;
-}
\ No newline at end of file
+}
+
+template <typename Policy>
+bool Simulator<Policy>::checkpoint() {
+    long long due = nextCheckpoint;
+    nextCheckpoint = nextCheckpointAfter(currentTime, checkpointInterval);
+    if (checkpointHandler) {
+        return checkpointHandler(due);
+    }
+    
+    // Written next to the target and renamed over it, so the file on disk is
+    // always a complete checkpoint even if the run is killed while saving
+    std::string temporary = checkpointFile + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("cannot write checkpoint " + temporary);
+        }
+        saveCheckpoint(out);
+    }
+    if (std::rename(temporary.c_str(), checkpointFile.c_str()) != 0) {
+        throw std::runtime_error("cannot write checkpoint " + checkpointFile);
+    }
+    return true;
+}
+
+template <typename Policy>
+void Simulator<Policy>::saveState(SnapshotWriter& out) const {
+    out.write(currentTime);
+    if (!out.isCanonical()) {
+        out.write(eventCount);
+    }
+    for (const Core& core : cores) {
+        out.writeHandle(core.runningProcess);
+        out.write(core.preemptionPending);
+    }
+    
+    processes.save(out);
+    blockedProcesses.save(out);
+    for (const IoDevice& device : devices) {
+        device.save(out);
+    }
+    eventQueue.save(out);
+    for (const Core& core : cores) {
+        core.scheduler->save(out);
+    }
+}
+
+template <typename Policy>
+void Simulator<Policy>::saveCanonicalState(std::ostream& stream) const {
+    CanonicalHandles canonical = processes.canonicalHandles();
+    SnapshotWriter out(stream, &canonical);
+    saveState(out);
+    out.finish();
+}
+
+template <typename Policy>
+void Simulator<Policy>::saveCheckpoint(std::ostream& stream) const {
+    SnapshotWriter out(stream);
+    
+    // Settings the rest of the state depends on, checked when restoring
+    out.write(CHECKPOINT_MAGIC);
+    out.write(CHECKPOINT_VERSION);
+    out.writeString(cores[0].scheduler->getName());
+    out.write<std::uint32_t>(static_cast<std::uint32_t>(cores.size()));
+    out.write(cores[0].scheduler->getProcessSwitchTime());
+    out.write(migrationCost);
+    out.write(detailedMode);
+    out.write<std::uint32_t>(static_cast<std::uint32_t>(deviceSettings.size()));
+    for (const IoDeviceSettings& settings : deviceSettings) {
+        out.write(settings.capacity);
+        out.write(settings.discipline);
+    }
+    
+    saveState(out);
+    arrivals.save(out);
+    stats.save(out);
+    out.finish();
+}
+
+template <typename Policy>
+void Simulator<Policy>::restoreCheckpoint(std::istream& stream) {
+    SnapshotReader in(stream);
+    
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    in.read(magic);
+    in.expect(std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) == 0, "not a checkpoint file");
+    in.expect(in.read<std::uint32_t>() == CHECKPOINT_VERSION, "unsupported checkpoint version");
+    bool sameScheduler = in.readString() == cores[0].scheduler->getName();
+    bool sameCores = in.read<std::uint32_t>() == cores.size();
+    bool sameSwitchTime = in.read<int>() == cores[0].scheduler->getProcessSwitchTime();
+    bool sameMigrationCost = in.read<int>() == migrationCost;
+    bool sameDetail = in.read<bool>() == detailedMode;
+    bool sameDevices = in.read<std::uint32_t>() == deviceSettings.size();
+    for (std::size_t i = 0; sameDevices && i < deviceSettings.size(); i++) {
+        sameDevices = in.read<int>() == deviceSettings[i].capacity;
+        sameDevices = in.read<IoDiscipline>() == deviceSettings[i].discipline && sameDevices;
+    }
+    in.expect(sameScheduler && sameCores && sameSwitchTime && sameMigrationCost && sameDetail && sameDevices,
+              "checkpoint was taken with different settings");
+    
+    in.read(currentTime);
+    in.read(eventCount);
+    std::vector<ProcessHandle> running(cores.size());
+    for (std::size_t i = 0; i < cores.size(); i++) {
+        in.read(running[i]);
+        in.read(cores[i].preemptionPending);
+    }
+    
+    processes.restore(in);
+    for (std::size_t i = 0; i < cores.size(); i++) {
+        in.expect(running[i] == NO_PROCESS || running[i] < processes.size(), "corrupt checkpoint");
+        cores[i].runningProcess = running[i];
+    }
+    blockedProcesses.restore(in, processes.size());
+    for (IoDevice& device : devices) {
+        device.restore(in, processes.size());
+    }
+    
+    eventQueue.restore(in, processes.size());
+    for (Core& core : cores) {
+        core.scheduler->restore(in);
+    }
+    arrivals.restore(in);
+    stats.restore(in);
+    
+    if (checkpointInterval > 0) {
+        nextCheckpoint = nextCheckpointAfter(currentTime, checkpointInterval);
+    }
+    restored = true;
+}
+
+template class Simulator<Scheduler>;
+template class Simulator<FCFSScheduler>;
+template class Simulator<SJFScheduler>;
+template class Simulator<SRTNScheduler>;
+template class Simulator<RRScheduler>;
+template class Simulator<MLFQScheduler>;
+template class Simulator<FairScheduler>;
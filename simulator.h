@@ -1,43 +1,149 @@
 #ifndef SIMULATOR_H
 #define SIMULATOR_H
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <memory_resource>
 #include <vector>
 #include <string>
-#include <map>
+#include <istream>
+#include <ostream>
 #include "process.h"
+#include "arrival.h"
 #include "event.h"
+#include "instrumentation.h"
+#include "io_device.h"
 #include "scheduler.h"
 #include "statistics.h"
+#include "timeline.h"
+#include "transition_log.h"
 
+// Run-time settings shared by every simulation run
+struct SimulationOptions {
+    bool verboseMode;
+    bool detailedMode;
+    EventQueueKind eventQueue;
+    int processSwitchTime;  // Overrides the workload's switch time when >= 0
+    int numCores;           // CPUs, each with its own run queue
+    int migrationCost;      // Extra delay when a core steals work from another
+    int checkpointInterval; // Save a checkpoint every this many time units; 0 disables
+    std::string checkpointFile;
+    std::string restoreFile;    // Checkpoint to resume from, if not empty
+    std::vector<IoDeviceSettings> ioDevices;    // Empty for unlimited parallel I/O
+    bool analyticFastPath;  // Evaluate runs that have a closed form without simulating
+    bool crossCheck;        // Also simulate those runs and fail if the results differ
+    std::string transitionLogFile;  // Verbose mode logs binary records here instead of text
+    std::string timelineFile;       // Chrome Trace Event timeline of the run, if not empty
+    
+    SimulationOptions()
+        : verboseMode(false), detailedMode(false), eventQueue(EventQueueKind::BINARY_HEAP),
+          processSwitchTime(-1), numCores(1), migrationCost(0), checkpointInterval(0),
+          checkpointFile("checkpoint.bin"), analyticFastPath(true), crossCheck(false) {}
+};
+
+// Event-driven simulation of one scheduling algorithm. Policy is either the
+// abstract Scheduler (virtual dispatch) or a concrete final scheduler, in which
+// case its queue operations are inlined into the event handlers. Instantiated
+// in simulator.cpp for Scheduler and every SchedulerPolicy alternative.
+template <typename Policy = Scheduler>
 class Simulator {
 private:
+    // One CPU and its private run queue
+    struct Core {
+        std::shared_ptr<Policy> scheduler;
+        ProcessHandle runningProcess;
+        bool preemptionPending;     // A PROCESS_PREEMPTED event is queued for this core
+    };
+    
     bool verboseMode;
     bool detailedMode;
+    std::ostream& traceStream;
+    TransitionLog* transitionLog;   // Receives transitions instead of traceStream, if set
+    EventType currentEvent;         // Event being handled
+    TimelineWriter* timeline;       // Receives every run, switch, ready and I/O interval, if set
     int currentTime;
     EventQueue eventQueue;
-    std::shared_ptr<Scheduler> scheduler;
-    std::shared_ptr<Process> runningProcess;
-    std::vector<std::shared_ptr<Process>> processes;
-    std::map<int, std::shared_ptr<Process>> blockedProcesses;
+    ArrivalSource& arrivals;
+    std::vector<Core> cores;
+    int migrationCost;
+    ProcessTable processes;
+    BlockedSet blockedProcesses;
+    // Process with id i does its I/O on device i % devices.size()
+    std::vector<IoDeviceSettings> deviceSettings;
+    std::vector<IoDevice> devices;
     Statistics stats;
+    std::uint64_t eventCount;   // Events processed by run()
+    int checkpointInterval;
+    std::string checkpointFile;
+    long long nextCheckpoint;   // Time at which the next checkpoint is due
+    std::function<bool(long long)> checkpointHandler;
+    bool restored;              // State came from a checkpoint; run() resumes it
+#ifdef SIM_INSTRUMENT
+    mutable Instrumentation instrumentation;   // Counted from const helpers too
+#endif
     
     // Helper methods
+    void admitNextArrival();
+    void terminateProcess(ProcessHandle process);
+    bool isStale(const Event& event) const;
     void processEvent(const Event& event);
-    void handleProcessArrival(std::shared_ptr<Process> process);
-    void handleCpuBurstCompletion(std::shared_ptr<Process> process);
-    void handleIoBurstCompletion(std::shared_ptr<Process> process);
-    void handleTimeSliceExpired(std::shared_ptr<Process> process);
-    void scheduleNextProcess();
-    void printStateTransition(std::shared_ptr<Process> process, 
+    void handleProcessArrival(ProcessHandle process);
+    void handleCpuBurstCompletion(ProcessHandle process);
+    void handleIoBurstCompletion(ProcessHandle process);
+    void handleTimeSliceExpired(ProcessHandle process);
+    void handleProcessPreempted(ProcessHandle process);
+    int deviceOf(ProcessHandle process) const;
+    void startIo(int device, const IoDevice::Request& request);
+    std::size_t countReadyProcesses() const;
+    int selectCore() const;
+    void makeReady(ProcessHandle process, int core);
+    void releaseCore(int core);
+    ProcessHandle stealProcess(int core);
+    void scheduleNextProcess(int core);
+    void printStateTransition(ProcessHandle process, 
                              ProcessState oldState, ProcessState newState);
+    bool checkpoint();
+    void saveState(SnapshotWriter& out) const;
     
 public:
-    Simulator(bool verboseMode, bool detailedMode, std::shared_ptr<Scheduler> scheduler);
+    // Processes are pulled from arrivals lazily as the simulation advances;
+    // schedulers holds one scheduler instance per core. The process table,
+    // event queue and statistics allocate from memory, which must outlive
+    // the simulator.
+    Simulator(const SimulationOptions& options, std::vector<std::shared_ptr<Policy>> schedulers,
+              ArrivalSource& arrivals, std::ostream& traceStream,
+              std::pmr::memory_resource* memory = std::pmr::get_default_resource());
     
-    void addProcess(std::shared_ptr<Process> process);
-    void run();
+    // Returns false if a checkpoint handler stopped the run early
+    bool run();
     Statistics getStatistics() const;
+    // Statistics gathered so far, without copying them
+    const Statistics& getRunningStatistics() const { return stats; }
+    void setOutcomeLog(std::vector<ProcessOutcome>* log) { stats.setOutcomeLog(log); }
+    int getCurrentTime() const { return currentTime; }
+    // Logs verbose transitions as binary records; log must outlive the run
+    void setTransitionLog(TransitionLog* log) { transitionLog = log; }
+    // Streams the run's timeline; writer must outlive the run
+    void setTimeline(TimelineWriter* writer) { timeline = writer; }
+    
+    // Complete state between two events as a binary snapshot. Restoring into
+    // a fresh simulator built with the same options, schedulers and workload
+    // lets run() continue exactly where the saved run was; restore throws
+    // std::runtime_error for a checkpoint that does not match.
+    void saveCheckpoint(std::ostream& out) const;
+    void restoreCheckpoint(std::istream& in);
+    
+    // Calls handler(due) instead of writing a checkpoint file whenever a
+    // checkpoint is due; returning false stops the run there
+    void setCheckpointHandler(std::function<bool(long long due)> handler) {
+        checkpointHandler = std::move(handler);
+    }
+    
+    // State of the run without its position in the workload or statistics,
+    // written canonically (see SnapshotWriter) for comparing two runs
+    void saveCanonicalState(std::ostream& out) const;
+    std::uint64_t getEventCount() const { return eventCount; }
 };
 
 #endif // SIMULATOR_H
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "snapshot.h"
+
+void SnapshotWriter::writeString(const std::string& value) {
+    write<std::uint64_t>(value.size());
+    out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+void SnapshotWriter::writeHandle(std::uint32_t handle) {
+    if (!canonical) {
+        write(handle);
+    } else {
+        write(handle < canonical->keys.size() ? canonical->keys[handle] : UINT64_MAX);
+    }
+}
+
+void SnapshotWriter::writeBytes(const std::uint8_t* data, std::size_t size) {
+    write<std::uint64_t>(size);
+    out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+void SnapshotWriter::finish() {
+    if (!out.flush()) {
+        throw std::runtime_error("error writing checkpoint");
+    }
+}
+
+void SnapshotReader::fail(const std::string& message) const {
+    throw std::runtime_error(message);
+}
+
+std::uint64_t SnapshotReader::readSize(std::uint64_t limit) {
+    std::uint64_t size = read<std::uint64_t>();
+    expect(size <= limit, "corrupt checkpoint");
+    return size;
+}
+
+std::string SnapshotReader::readString() {
+    std::string value(static_cast<std::size_t>(readSize(UINT32_MAX)), '\0');
+    if (!in.read(&value[0], static_cast<std::streamsize>(value.size()))) {
+        fail("truncated checkpoint");
+    }
+    return value;
+}
@@ -0,0 +1,126 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Live processes of a run in input order, for writing canonical snapshots
+struct CanonicalHandles {
+    std::vector<std::uint64_t> keys;    // Input position of the process in each slot
+    std::vector<std::uint32_t> order;   // Live slots sorted by input position
+};
+
+// Binary checkpoint streams. Values are stored in host byte order exactly as
+// they are held in memory, so a restored run continues bit for bit; vectors
+// are stored as a 64-bit length followed by their elements. A checkpoint is
+// only meant to be read back by the same build on the same machine type.
+//
+// A canonical writer is only used to compare two runs. It writes process
+// handles as input positions and leaves out whatever only breaks ties
+// (sequence numbers, heap layout, slot numbers), so two runs that will
+// behave the same from here on write the same bytes. It cannot be restored.
+class SnapshotWriter {
+private:
+    std::ostream& out;
+    const CanonicalHandles* canonical;
+
+public:
+    explicit SnapshotWriter(std::ostream& out, const CanonicalHandles* canonical = nullptr)
+        : out(out), canonical(canonical) {}
+    
+    bool isCanonical() const { return canonical != nullptr; }
+    const CanonicalHandles& getCanonicalHandles() const { return *canonical; }
+    
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values can be written");
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    
+    // Writes a contiguous container of plain values in one block
+    template <typename Vector>
+    void writeVector(const Vector& values) {
+        using Value = typename Vector::value_type;
+        static_assert(std::is_trivially_copyable<Value>::value, "only plain values can be written");
+        write<std::uint64_t>(values.size());
+        out.write(reinterpret_cast<const char*>(values.data()),
+                  static_cast<std::streamsize>(values.size() * sizeof(Value)));
+    }
+    
+    void writeString(const std::string& value);
+    // A process handle, or its input position when canonical; handles past
+    // the process table (NO_PROCESS) are written as all ones
+    void writeHandle(std::uint32_t handle);
+    void writeBytes(const std::uint8_t* data, std::size_t size);   // Read back with readVector
+    
+    // Throws std::runtime_error if any write failed
+    void finish();
+};
+
+// Reads what SnapshotWriter wrote. Every read throws std::runtime_error on a
+// truncated or malformed checkpoint.
+class SnapshotReader {
+private:
+    std::istream& in;
+    
+    void fail(const std::string& message) const;
+
+public:
+    explicit SnapshotReader(std::istream& in) : in(in) {}
+    
+    template <typename T>
+    void read(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values can be read");
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+            fail("truncated checkpoint");
+        }
+    }
+    
+    template <typename T>
+    T read() {
+        T value;
+        read(value);
+        return value;
+    }
+    
+    // Reads a length; fails if it is larger than limit
+    std::uint64_t readSize(std::uint64_t limit);
+    
+    // Replaces the contents of a contiguous container. Large vectors are read
+    // in blocks, so a corrupt length fails on the data instead of allocating it all.
+    template <typename Vector>
+    void readVector(Vector& values) {
+        using Value = typename Vector::value_type;
+        static_assert(std::is_trivially_copyable<Value>::value, "only plain values can be read");
+        const std::size_t BLOCK = 1 << 16;
+        std::size_t size = static_cast<std::size_t>(readSize(UINT32_MAX));
+        values.clear();
+        while (values.size() < size) {
+            std::size_t offset = values.size();
+            std::size_t count = std::min(BLOCK, size - offset);
+            values.resize(offset + count);
+            if (!in.read(reinterpret_cast<char*>(values.data() + offset),
+                         static_cast<std::streamsize>(count * sizeof(Value)))) {
+                fail("truncated checkpoint");
+            }
+        }
+    }
+    
+    std::string readString();
+    
+    // Fails with message unless condition holds; used to validate restored state
+    void expect(bool condition, const std::string& message) const {
+        if (!condition) {
+            fail(message);
+        }
+    }
+};
+
+#endif // SNAPSHOT_H
@@ -2,9 +2,19 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
+#include <utility>
+#include "snapshot.h"
 
-Statistics::Statistics()
-    : totalTime(0), cpuBusyTime(0), processSwitchTime(0) {
+Statistics::Statistics(std::pmr::memory_resource* memory)
+    : totalTime(0), cpuBusyTime(0), processSwitchTime(0), finishedProcesses(0),
+      totalTurnaroundTime(0), recordProcesses(false), processes(memory), coreBusyTimes(1, 0, memory),
+      migrations(0), devices(memory), turnaroundTimes(memory), waitTimes(memory), responseTimes(memory),
+      outcomeLog(nullptr) {
+}
+
+void Statistics::setRecordProcesses(bool record) {
+    recordProcesses = record;
 }
 
 void Statistics::setTotalTime(int time) {
@@ -19,8 +29,102 @@ void Statistics::addProcessSwitchTime(int time) {
     processSwitchTime += time;
 }
 
-void Statistics::addProcess(std::shared_ptr<Process> process) {
-    processes.push_back(process);
+void Statistics::setCoreCount(int count) {
+    coreBusyTimes.assign(count, 0);
+}
+
+void Statistics::addCoreBusyTime(int core, int time) {
+    coreBusyTimes[core] += time;
+}
+
+void Statistics::addMigration() {
+    migrations++;
+}
+
+void Statistics::addDevice(int capacity) {
+    devices.push_back(DeviceUsage{capacity, 0, 0, 0, 0});
+}
+
+void Statistics::addIoRequest(int device, int serviceTime, int queueTime) {
+    DeviceUsage& usage = devices[device];
+    usage.busyTime += serviceTime;
+    usage.requests++;
+    if (queueTime > 0) {
+        usage.queuedRequests++;
+        usage.queueTime += queueTime;
+    }
+}
+
+void Statistics::addProcess(const ProcessTable& table, ProcessHandle process) {
+    ProcessOutcome outcome;
+    ProcessRecord& record = outcome.record;
+    record.inputOrder = table.getInputOrder(process);
+    record.id = table.getId(process);
+    record.arrivalTime = table.getArrivalTime(process);
+    record.serviceTime = table.getServiceTime(process);
+    record.ioTime = table.getIoTime(process);
+    record.turnaroundTime = table.getTurnaroundTime(process);
+    record.finishTime = table.getFinishTime(process);
+    outcome.waitTime = table.getWaitTime(process);
+    outcome.responseTime = table.getStartTime(process) - table.getArrivalTime(process);
+    
+    addOutcome(outcome);
+    if (outcomeLog) {
+        outcomeLog->push_back(outcome);
+    }
+}
+
+void Statistics::addOutcome(const ProcessOutcome& outcome) {
+    int turnaroundTime = outcome.record.turnaroundTime;
+    if (turnaroundTime >= 0) {
+        finishedProcesses++;
+        totalTurnaroundTime += turnaroundTime;
+        turnaroundTimes.add(turnaroundTime);
+        waitTimes.add(outcome.waitTime);
+        responseTimes.add(outcome.responseTime);
+    }
+    
+    if (recordProcesses) {
+        processes.push_back(outcome.record);
+    }
+}
+
+void Statistics::addRecord(const ProcessRecord& record) {
+    processes.push_back(record);
+}
+
+StatisticsTotals Statistics::getTotals() const {
+    StatisticsTotals totals;
+    totals.cpuBusyTime = cpuBusyTime;
+    totals.processSwitchTime = processSwitchTime;
+    totals.migrations = migrations;
+    totals.coreBusyTimes.assign(coreBusyTimes.begin(), coreBusyTimes.end());
+    totals.devices.assign(devices.begin(), devices.end());
+    return totals;
+}
+
+void Statistics::addTotals(const StatisticsTotals& start, const StatisticsTotals& end) {
+    cpuBusyTime += end.cpuBusyTime - start.cpuBusyTime;
+    processSwitchTime += end.processSwitchTime - start.processSwitchTime;
+    migrations += end.migrations - start.migrations;
+    for (std::size_t core = 0; core < coreBusyTimes.size(); core++) {
+        coreBusyTimes[core] += end.coreBusyTimes[core] - start.coreBusyTimes[core];
+    }
+    for (std::size_t device = 0; device < devices.size(); device++) {
+        const DeviceUsage& from = start.devices[device];
+        const DeviceUsage& to = end.devices[device];
+        devices[device].busyTime += to.busyTime - from.busyTime;
+        devices[device].requests += to.requests - from.requests;
+        devices[device].queuedRequests += to.queuedRequests - from.queuedRequests;
+        devices[device].queueTime += to.queueTime - from.queueTime;
+    }
+}
+
+void Statistics::sortProcesses() {
+    std::stable_sort(processes.begin(), processes.end(),
+                     [](const ProcessRecord& a, const ProcessRecord& b) {
+                         return a.inputOrder < b.inputOrder;
+                     });
 }
 
 int Statistics::getTotalTime() const {
@@ -32,30 +136,210 @@ double Statistics::getCpuUtilization() const {
         return 0.0;
     }
     
-    return static_cast<double>(cpuBusyTime) / totalTime * 100.0;
+    // Averaged over the cores, so it agrees with the per-core figures
+    return static_cast<double>(cpuBusyTime) / (static_cast<double>(totalTime) * coreBusyTimes.size()) * 100.0;
+}
+
+int Statistics::getFinishedProcesses() const {
+    return finishedProcesses;
+}
+
+double Statistics::getMeanTurnaroundTime() const {
+    if (finishedProcesses == 0) {
+        return 0.0;
+    }
+    
+    return static_cast<double>(totalTurnaroundTime) / finishedProcesses;
+}
+
+int Statistics::getCoreCount() const {
+    return static_cast<int>(coreBusyTimes.size());
+}
+
+double Statistics::getCoreUtilization(int core) const {
+    if (totalTime <= 0) {
+        return 0.0;
+    }
+    
+    return static_cast<double>(coreBusyTimes[core]) / totalTime * 100.0;
+}
+
+long long Statistics::getMigrations() const {
+    return migrations;
 }
 
-std::vector<std::shared_ptr<Process>> Statistics::getProcesses() const {
+int Statistics::getDeviceCount() const {
+    return static_cast<int>(devices.size());
+}
+
+double Statistics::getDeviceUtilization(int device) const {
+    if (totalTime <= 0) {
+        return 0.0;
+    }
+    
+    return static_cast<double>(devices[device].busyTime) / (static_cast<double>(totalTime) * devices[device].capacity)
+           * 100.0;
+}
+
+double Statistics::getMeanQueueingDelay(int device) const {
+    if (devices[device].requests == 0) {
+        return 0.0;
+    }
+    
+    return static_cast<double>(devices[device].queueTime) / devices[device].requests;
+}
+
+const std::pmr::vector<ProcessRecord>& Statistics::getProcesses() const {
     return processes;
 }
 
+std::string Statistics::compare(const Statistics& other) const {
+    auto sameRecord = [](const ProcessRecord& a, const ProcessRecord& b) {
+        return a.inputOrder == b.inputOrder && a.id == b.id && a.arrivalTime == b.arrivalTime &&
+               a.serviceTime == b.serviceTime && a.ioTime == b.ioTime &&
+               a.turnaroundTime == b.turnaroundTime && a.finishTime == b.finishTime;
+    };
+    auto sameDevice = [](const DeviceUsage& a, const DeviceUsage& b) {
+        return a.capacity == b.capacity && a.busyTime == b.busyTime && a.requests == b.requests &&
+               a.queuedRequests == b.queuedRequests && a.queueTime == b.queueTime;
+    };
+    
+    if (totalTime != other.totalTime) {
+        return "total time";
+    } else if (cpuBusyTime != other.cpuBusyTime) {
+        return "CPU busy time";
+    } else if (processSwitchTime != other.processSwitchTime) {
+        return "process switch time";
+    } else if (finishedProcesses != other.finishedProcesses) {
+        return "finished processes";
+    } else if (totalTurnaroundTime != other.totalTurnaroundTime) {
+        return "total turnaround time";
+    } else if (coreBusyTimes != other.coreBusyTimes) {
+        return "core busy times";
+    } else if (migrations != other.migrations) {
+        return "migrations";
+    } else if (!std::equal(devices.begin(), devices.end(), other.devices.begin(), other.devices.end(), sameDevice)) {
+        return "I/O devices";
+    } else if (!(turnaroundTimes == other.turnaroundTimes)) {
+        return "turnaround time distribution";
+    } else if (!(waitTimes == other.waitTimes)) {
+        return "wait time distribution";
+    } else if (!(responseTimes == other.responseTimes)) {
+        return "response time distribution";
+    } else if (!std::equal(processes.begin(), processes.end(), other.processes.begin(), other.processes.end(),
+                           sameRecord)) {
+        return "process records";
+    }
+    return "";
+}
+
+void Statistics::printCoreOutput() const {
+    // Single-CPU runs keep the original output format
+    if (coreBusyTimes.size() <= 1) {
+        return;
+    }
+    
+    for (int core = 0; core < getCoreCount(); core++) {
+        std::cout << "CPU " << core << " Utilization is "
+                  << static_cast<int>(std::round(getCoreUtilization(core))) << "%\n";
+    }
+    std::cout << "Process migrations: " << migrations << "\n";
+}
+
+void Statistics::printDeviceOutput() const {
+    // Runs with unlimited I/O keep the original output format
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2);
+    for (int device = 0; device < getDeviceCount(); device++) {
+        const DeviceUsage& usage = devices[device];
+        std::cout << "I/O device " << device << " Utilization is "
+                  << static_cast<int>(std::round(getDeviceUtilization(device))) << "%, "
+                  << usage.queuedRequests << " of " << usage.requests << " requests queued, "
+                  << "mean queueing delay " << getMeanQueueingDelay(device) << " units\n";
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+void Statistics::printDistributionOutput() const {
+    const std::pair<const char*, const Distribution*> distributions[] = {
+        {"Turnaround", &turnaroundTimes}, {"Wait", &waitTimes}, {"Response", &responseTimes}
+    };
+    
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& entry : distributions) {
+        const Distribution& distribution = *entry.second;
+        std::cout << entry.first << " time: mean " << distribution.mean()
+                  << " stddev " << distribution.stddev()
+                  << " p50 " << distribution.percentile(50)
+                  << " p95 " << distribution.percentile(95)
+                  << " p99 " << distribution.percentile(99)
+                  << " p999 " << distribution.percentile(99.9) << " units\n";
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
 void Statistics::printDefaultOutput(const std::string& algorithm) const {
     std::cout << algorithm << ":\n";
     std::cout << "Total Time required is " << totalTime << " time units\n";
     std::cout << "CPU Utilization is " << static_cast<int>(std::round(getCpuUtilization())) << "%\n";
+    printCoreOutput();
+    printDeviceOutput();
 }
 
 void Statistics::printDetailedOutput(const std::string& algorithm) const {
     std::cout << algorithm << ":\n";
     std::cout << "Total Time required is " << totalTime << " units\n";
     std::cout << "CPU Utilization is " << static_cast<int>(std::round(getCpuUtilization())) << "%\n";
+    printCoreOutput();
+    printDeviceOutput();
     
     for (const auto& process : processes) {
-        std::cout << "Process " << process->getId() << ": ";
-        std::cout << "arrival time: " << process->getArrivalTime() << " ";
-        std::cout << "service time: " << process->getServiceTime() << " units ";
-        std::cout << "I/O time: " << process->getIoTime() << " units ";
-        std::cout << "turnaround time: " << process->getTurnaroundTime() << " units ";
-        std::cout << "finish time: " << process->getFinishTime() << " units\n";
-    }
-}
\ No newline at end of file
+        std::cout << "Process " << process.id << ": ";
+        std::cout << "arrival time: " << process.arrivalTime << " ";
+        std::cout << "service time: " << process.serviceTime << " units ";
+        std::cout << "I/O time: " << process.ioTime << " units ";
+        std::cout << "turnaround time: " << process.turnaroundTime << " units ";
+        std::cout << "finish time: " << process.finishTime << " units\n";
+    }
+}
+
+void Statistics::save(SnapshotWriter& out) const {
+    out.write(totalTime);
+    out.write(cpuBusyTime);
+    out.write(processSwitchTime);
+    out.write(finishedProcesses);
+    out.write(totalTurnaroundTime);
+    out.write(recordProcesses);
+    out.writeVector(processes);
+    out.writeVector(coreBusyTimes);
+    out.write(migrations);
+    out.writeVector(devices);
+    turnaroundTimes.save(out);
+    waitTimes.save(out);
+    responseTimes.save(out);
+}
+
+void Statistics::restore(SnapshotReader& in) {
+    std::size_t coreCount = coreBusyTimes.size();
+    in.read(totalTime);
+    in.read(cpuBusyTime);
+    in.read(processSwitchTime);
+    in.read(finishedProcesses);
+    in.read(totalTurnaroundTime);
+    in.read(recordProcesses);
+    in.readVector(processes);
+    in.readVector(coreBusyTimes);
+    in.expect(coreBusyTimes.size() == coreCount, "corrupt checkpoint");
+    in.read(migrations);
+    std::size_t deviceCount = devices.size();
+    in.readVector(devices);
+    in.expect(devices.size() == deviceCount, "corrupt checkpoint");
+    turnaroundTimes.restore(in);
+    waitTimes.restore(in);
+    responseTimes.restore(in);
+}
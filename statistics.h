@@ -1,32 +1,131 @@
 #ifndef STATISTICS_H
 #define STATISTICS_H
 
-#include <memory>
+#include <cstdint>
+#include <memory_resource>
 #include <vector>
 #include <map>
 #include <string>
+#include "distribution.h"
+#include "instrumentation.h"
 #include "process.h"
 
+// Final per-process figures copied out of the ProcessTable of a run
+struct ProcessRecord {
+    std::uint64_t inputOrder;
+    int id;
+    int arrivalTime;
+    int serviceTime;
+    int ioTime;
+    int turnaroundTime;
+    int finishTime;
+};
+
+// Everything a process contributes to the statistics of its run
+struct ProcessOutcome {
+    ProcessRecord record;   // turnaroundTime is negative for unfinished processes
+    int waitTime;
+    int responseTime;
+};
+
+// I/O served by one device over a run
+struct DeviceUsage {
+    int capacity;
+    long long busyTime;         // Summed over its channels
+    long long requests;
+    long long queuedRequests;   // Requests that found every channel busy
+    long long queueTime;        // Total time requests waited for a channel
+};
+
+// Counters of a run that only ever grow, for combining two runs
+struct StatisticsTotals {
+    int cpuBusyTime;
+    int processSwitchTime;
+    long long migrations;
+    std::vector<long long> coreBusyTimes;
+    std::vector<DeviceUsage> devices;
+};
+
 class Statistics {
 private:
     int totalTime;
-    int cpuBusyTime;
+    int cpuBusyTime;        // Summed over all cores
     int processSwitchTime;
-    std::vector<std::shared_ptr<Process>> processes;
+    int finishedProcesses;
+    long long totalTurnaroundTime;
+    bool recordProcesses;   // Keep a ProcessRecord per process (detailed output)
+    std::pmr::vector<ProcessRecord> processes;
+    std::pmr::vector<long long> coreBusyTimes;  // Time each CPU spent running processes
+    long long migrations;                       // Processes stolen by another core
+    std::pmr::vector<DeviceUsage> devices;      // Empty when I/O is unlimited
+    
+    // Per-process figures of finished processes, accumulated as they terminate
+    Distribution turnaroundTimes;
+    Distribution waitTimes;         // Time spent in ready queues
+    Distribution responseTimes;     // Arrival until first dispatch
+    std::vector<ProcessOutcome>* outcomeLog;    // Receives every process added, if set
+#ifdef SIM_INSTRUMENT
+    Instrumentation instrumentation;
+#endif
     
 public:
-    Statistics();
+    // Records allocate from memory while the run fills them in; copies use
+    // the default resource, so a copy outlives the arena of its run
+    explicit Statistics(std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    
+    void setRecordProcesses(bool record);
     
     void setTotalTime(int time);
     void addCpuBusyTime(int time);
     void addProcessSwitchTime(int time);
-    void addProcess(std::shared_ptr<Process> process);
+    void setCoreCount(int count);
+    void addCoreBusyTime(int core, int time);
+    void addMigration();
+    void addDevice(int capacity);
+    // Accounts for a request that waited queueTime before being served for serviceTime
+    void addIoRequest(int device, int serviceTime, int queueTime);
+    // Accounts for a finished (or, at the end of a run, unfinished) process
+    void addProcess(const ProcessTable& table, ProcessHandle process);
+    void addOutcome(const ProcessOutcome& outcome);
+    void addRecord(const ProcessRecord& record);    // Record only, whether or not recording
+    // Logs the outcome of every process added from here on; log must outlive the run
+    void setOutcomeLog(std::vector<ProcessOutcome>* log) { outcomeLog = log; }
+    StatisticsTotals getTotals() const;
+    // Adds what the totals grew by from start to end
+    void addTotals(const StatisticsTotals& start, const StatisticsTotals& end);
+    void sortProcesses();   // Puts process records back in input order
     
     int getTotalTime() const;
     double getCpuUtilization() const;
-    std::vector<std::shared_ptr<Process>> getProcesses() const;
+    int getFinishedProcesses() const;
+    double getMeanTurnaroundTime() const;
+    int getCoreCount() const;
+    double getCoreUtilization(int core) const;
+    long long getMigrations() const;
+    int getDeviceCount() const;
+    double getDeviceUtilization(int device) const;
+    double getMeanQueueingDelay(int device) const;
+    const Distribution& getTurnaroundDistribution() const { return turnaroundTimes; }
+    const Distribution& getWaitDistribution() const { return waitTimes; }
+    const Distribution& getResponseDistribution() const { return responseTimes; }
+#ifdef SIM_INSTRUMENT
+    void setInstrumentation(const Instrumentation& counters) { instrumentation = counters; }
+    const Instrumentation& getInstrumentation() const { return instrumentation; }
+#endif
+    const std::pmr::vector<ProcessRecord>& getProcesses() const;
+    // Every figure, distribution and process record is identical; empty if
+    // so, otherwise the name of the first figure that differs
+    std::string compare(const Statistics& other) const;
+    
+    // Checkpointing of the figures gathered so far. Instrumentation counters
+    // are not saved and restart from zero in a restored run.
+    void save(SnapshotWriter& out) const;
+    void restore(SnapshotReader& in);
     
     // Methods for different output formats
+    void printCoreOutput() const;
+    void printDeviceOutput() const;
+    void printDistributionOutput() const;   // Mean, deviation and percentiles
     void printDefaultOutput(const std::string& algorithm) const;
     void printDetailedOutput(const std::string& algorithm) const;
 };
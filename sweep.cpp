@@ -0,0 +1,160 @@
+#include "sweep.h"
+#include <cstdlib>
+#include <fstream>
+#include <memory_resource>
+#include <sstream>
+#include <stdexcept>
+#include "analytic.h"
+#include "arena.h"
+#include "arrival.h"
+#include "parallel.h"
+#include "scheduler.h"
+#include "simulator.h"
+
+Statistics runSimulation(const std::string& algorithm, const Workload& workload,
+                         const SimulationOptions& options, std::ostream& traceStream) {
+    Statistics analytic;
+    bool evaluated = options.analyticFastPath && evaluateAnalytically(algorithm, workload, options, analytic);
+    if (evaluated && !options.crossCheck) {
+        return analytic;
+    }
+    
+    // Everything the run allocates comes from its arena and is released at
+    // once when the run returns; the statistics are copied out first
+    SimulationArena arena;
+    
+    return visitSimulation(algorithm, workload, options, traceStream, arena.resource(),
+                           [&](auto& simulator, ArrivalSource&) {
+        if (!options.restoreFile.empty()) {
+            std::ifstream checkpoint(options.restoreFile, std::ios::binary);
+            if (!checkpoint) {
+                throw std::runtime_error("cannot open checkpoint " + options.restoreFile);
+            }
+            simulator.restoreCheckpoint(checkpoint);
+        }
+        
+        // Verbose transitions go to a binary log drained by a writer thread
+        std::unique_ptr<TransitionLog> transitionLog;
+        if (options.verboseMode && !options.transitionLogFile.empty()) {
+            transitionLog.reset(new TransitionLog(options.transitionLogFile));
+            simulator.setTransitionLog(transitionLog.get());
+        }
+        
+        // The timeline is streamed to its file in chunks as the run goes
+        std::unique_ptr<TimelineWriter> timeline;
+        if (!options.timelineFile.empty()) {
+            timeline.reset(new TimelineWriter(options.timelineFile, options.numCores));
+            simulator.setTimeline(timeline.get());
+        }
+        
+        // Run simulation
+        simulator.run();
+        if (transitionLog) {
+            transitionLog->close();
+        }
+        if (timeline) {
+            timeline->close();
+        }
+        
+        Statistics stats = simulator.getStatistics();
+        std::string difference = evaluated ? analytic.compare(stats) : "";
+        if (!difference.empty()) {
+            throw std::runtime_error("Analytic " + algorithm + " result differs from the simulation in " +
+                                     difference);
+        }
+        return stats;
+    });
+}
+
+std::vector<SweepResult> runSweep(const std::vector<std::string>& algorithms,
+                                  const Workload& workload, const SimulationOptions& options,
+                                  unsigned numThreads) {
+    std::vector<SweepResult> results(algorithms.size());
+    
+    parallelFor(algorithms.size(), numThreads, [&](std::size_t i) {
+        SweepResult& result = results[i];
+        result.algorithm = algorithms[i];
+        result.schedulerName = createScheduler(algorithms[i], workload.processSwitchTime)->getName();
+        
+        // Buffer the trace so concurrent runs don't interleave their output
+        std::ostringstream trace;
+        result.stats = runSimulation(algorithms[i], workload, options, trace);
+        result.trace = trace.str();
+    });
+    
+    return results;
+}
+
+std::vector<int> ParameterRange::values() const {
+    std::vector<int> result;
+    for (long long value = first; value <= last; value += step) {
+        result.push_back(static_cast<int>(value));
+    }
+    return result;
+}
+
+bool parseParameterRange(const std::string& text, ParameterRange& range) {
+    std::vector<int> fields;
+    std::size_t start = 0;
+    
+    for (;;) {
+        std::size_t colon = text.find(':', start);
+        std::string field = text.substr(start, colon == std::string::npos ? std::string::npos
+                                                                         : colon - start);
+        char* end = nullptr;
+        long value = std::strtol(field.c_str(), &end, 10);
+        if (field.empty() || *end != '\0' || fields.size() == 3) {
+            return false;
+        }
+        fields.push_back(static_cast<int>(value));
+        
+        if (colon == std::string::npos) {
+            break;
+        }
+        start = colon + 1;
+    }
+    
+    range.first = fields[0];
+    range.last = fields.size() > 1 ? fields[1] : fields[0];
+    range.step = fields.size() > 2 ? fields[2] : 1;
+    return range.step > 0 && range.last >= range.first;
+}
+
+std::vector<GridPoint> runParameterSweep(const std::vector<std::string>& algorithms,
+                                         const std::vector<int>& switchTimes,
+                                         const Workload& workload,
+                                         const SimulationOptions& options,
+                                         unsigned numThreads) {
+    std::vector<GridPoint> points(algorithms.size() * switchTimes.size());
+    SimulationOptions quietOptions = options;
+    quietOptions.verboseMode = false;
+    quietOptions.detailedMode = false;
+    
+    // All points share the same read-only workload
+    parallelFor(points.size(), numThreads, [&](std::size_t i) {
+        GridPoint& point = points[i];
+        point.algorithm = algorithms[i / switchTimes.size()];
+        point.timeQuantum = isRoundRobinAlgorithm(point.algorithm) ? std::atoi(point.algorithm.c_str() + 2) : 0;
+        point.processSwitchTime = switchTimes[i % switchTimes.size()];
+        
+        SimulationOptions pointOptions = quietOptions;
+        pointOptions.processSwitchTime = point.processSwitchTime;
+        std::ostringstream unusedTrace;
+        point.stats = runSimulation(point.algorithm, workload, pointOptions, unusedTrace);
+    });
+    
+    return points;
+}
+
+void printSweepCsv(const std::vector<GridPoint>& points, std::ostream& out) {
+    out << "algorithm,quantum,switch_time,total_time,throughput,cpu_utilization,mean_turnaround\n";
+    for (const auto& point : points) {
+        const Statistics& stats = point.stats;
+        double throughput = stats.getTotalTime() > 0
+            ? 1000.0 * stats.getFinishedProcesses() / stats.getTotalTime() : 0.0;
+        
+        out << point.algorithm << "," << point.timeQuantum << "," << point.processSwitchTime << ","
+            << stats.getTotalTime() << "," << throughput << "," << stats.getCpuUtilization() << ","
+            << stats.getMeanTurnaroundTime() << "\n";
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "arrival.h"
+#include "scheduler.h"
+#include "simulator.h"
+#include "statistics.h"
+#include "workload.h"
+
+// Result of a single algorithm run within a sweep
+struct SweepResult {
+    std::string algorithm;
+    std::string schedulerName;
+    Statistics stats;
+    std::string trace;      // Verbose state transitions, empty unless requested
+};
+
+// Builds a fresh simulator for one run of algorithm over the workload and
+// returns visit(simulator, arrivals). The simulator runs on the concrete
+// scheduler type so queue operations are inlined; everything it allocates
+// comes from memory.
+template <typename Visitor>
+auto visitSimulation(const std::string& algorithm, const Workload& workload,
+                     const SimulationOptions& options, std::ostream& traceStream,
+                     std::pmr::memory_resource* memory, Visitor visit) {
+    int processSwitchTime = options.processSwitchTime >= 0 ? options.processSwitchTime
+                                                           : workload.processSwitchTime;
+    return std::visit([&](auto&& prototype) {
+        using Policy = std::decay_t<decltype(prototype)>;
+        std::pmr::polymorphic_allocator<Policy> allocator(memory);
+        std::vector<std::shared_ptr<Policy>> schedulers;
+        schedulers.push_back(std::allocate_shared<Policy>(allocator, std::move(prototype)));
+        for (int core = 1; core < options.numCores; core++) {
+            schedulers.push_back(std::allocate_shared<Policy>(
+                allocator, std::get<Policy>(createSchedulerPolicy(algorithm, processSwitchTime, memory))));
+        }
+        
+        // Each run pulls its own process state from the shared workload
+        std::unique_ptr<ArrivalSource> arrivals = openArrivalSource(workload, memory);
+        Simulator<Policy> simulator(options, schedulers, *arrivals, traceStream, memory);
+        return visit(simulator, *arrivals);
+    }, createSchedulerPolicy(algorithm, processSwitchTime, memory));
+}
+
+// Runs one algorithm over the workload with freshly created per-run process state
+Statistics runSimulation(const std::string& algorithm, const Workload& workload,
+                         const SimulationOptions& options, std::ostream& traceStream);
+
+// Runs every algorithm over the same workload, each on its own worker thread.
+// Results are returned in the order of the algorithms argument and are
+// identical to running the algorithms one after another.
+std::vector<SweepResult> runSweep(const std::vector<std::string>& algorithms,
+                                  const Workload& workload, const SimulationOptions& options,
+                                  unsigned numThreads = 0);
+
+// Inclusive integer range with a positive step, written "first:last[:step]"
+struct ParameterRange {
+    int first;
+    int last;
+    int step;
+    
+    ParameterRange() : first(0), last(0), step(1) {}
+    std::vector<int> values() const;
+};
+
+// Parses "first:last[:step]" or a single value; returns false if malformed
+bool parseParameterRange(const std::string& text, ParameterRange& range);
+
+// One point of a parameter grid and its result
+struct GridPoint {
+    std::string algorithm;
+    int timeQuantum;        // 0 for algorithms without a quantum
+    int processSwitchTime;
+    Statistics stats;
+};
+
+// Evaluates every (algorithm, switch time) pair over the shared workload in
+// parallel. Points are returned algorithm-major in argument order.
+std::vector<GridPoint> runParameterSweep(const std::vector<std::string>& algorithms,
+                                         const std::vector<int>& switchTimes,
+                                         const Workload& workload,
+                                         const SimulationOptions& options,
+                                         unsigned numThreads = 0);
+
+// Writes the grid as CSV: algorithm, quantum, switch time, total time,
+// throughput (processes per 1000 time units), utilization, mean turnaround
+void printSweepCsv(const std::vector<GridPoint>& points, std::ostream& out);
+
+#endif // SWEEP_H
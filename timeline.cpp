@@ -0,0 +1,178 @@
+#include "timeline.h"
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+
+// Trace processes grouping the tracks
+const int CPU_PID = 1;
+const int PROCESS_PID = 2;
+
+} // namespace
+
+TimelineWriter::TimelineWriter(const std::string& path, int numCores)
+    : out(path, std::ios::binary | std::ios::trunc), path(path), firstEvent(true),
+      runStarts(static_cast<std::size_t>(numCores), -1) {
+    if (!out) {
+        throw std::runtime_error("cannot create " + path);
+    }
+    buffer.reserve(CHUNK_SIZE + 4096);
+    buffer += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    
+    processName(CPU_PID, "CPUs");
+    processName(PROCESS_PID, "Processes");
+    for (int core = 0; core < numCores; core++) {
+        threadName(CPU_PID, core, "CPU " + std::to_string(core));
+    }
+}
+
+TimelineWriter::~TimelineWriter() {
+    if (out.is_open()) {
+        try {
+            close();
+        } catch (const std::exception&) {
+        }
+    }
+}
+
+void TimelineWriter::beginEvent() {
+    buffer += firstEvent ? "\n" : ",\n";
+    firstEvent = false;
+}
+
+void TimelineWriter::appendInt(long long value) {
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr);
+}
+
+void TimelineWriter::appendString(const std::string& value) {
+    buffer += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            buffer += '\\';
+        }
+        buffer += c;
+    }
+    buffer += '"';
+}
+
+void TimelineWriter::interval(int pid, long long tid, const char* name, int id, int start, int end) {
+    beginEvent();
+    buffer += "{\"ph\":\"X\",\"name\":\"";
+    buffer += name;
+    buffer += "\",\"pid\":";
+    appendInt(pid);
+    buffer += ",\"tid\":";
+    appendInt(tid);
+    buffer += ",\"ts\":";
+    appendInt(start);
+    buffer += ",\"dur\":";
+    appendInt(static_cast<long long>(end) - start);
+    if (id >= 0) {
+        buffer += ",\"args\":{\"process\":";
+        appendInt(id);
+        buffer += '}';
+    }
+    buffer += '}';
+    flushIfFull();
+}
+
+void TimelineWriter::processName(int pid, const std::string& name) {
+    beginEvent();
+    buffer += "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":";
+    appendInt(pid);
+    buffer += ",\"args\":{\"name\":";
+    appendString(name);
+    buffer += "}}";
+    flushIfFull();
+}
+
+void TimelineWriter::threadName(int pid, long long tid, const std::string& name) {
+    beginEvent();
+    buffer += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":";
+    appendInt(pid);
+    buffer += ",\"tid\":";
+    appendInt(tid);
+    buffer += ",\"args\":{\"name\":";
+    appendString(name);
+    buffer += "}}";
+    flushIfFull();
+}
+
+void TimelineWriter::flushIfFull() {
+    if (buffer.size() >= CHUNK_SIZE) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+}
+
+void TimelineWriter::processArrived(int id, int time) {
+    (void)time;
+    threadName(PROCESS_PID, id, "Process " + std::to_string(id));
+}
+
+void TimelineWriter::runStarted(int core, int time) {
+    runStarts[static_cast<std::size_t>(core)] = time;
+}
+
+void TimelineWriter::runEnded(int core, int id, int time) {
+    int& start = runStarts[static_cast<std::size_t>(core)];
+    if (start >= 0 && time > start) {
+        // Run intervals are named after the process so each one gets its colour
+        std::string name = "P" + std::to_string(id);
+        interval(CPU_PID, core, name.c_str(), id, start, time);
+    }
+    start = -1;
+}
+
+void TimelineWriter::processSwitch(int core, int start, int duration) {
+    if (duration > 0) {
+        interval(CPU_PID, core, "switch", -1, start, start + duration);
+    }
+}
+
+void TimelineWriter::migration(int core, int id, int start, int end) {
+    if (end > start) {
+        interval(CPU_PID, core, "migration", id, start, end);
+    }
+}
+
+void TimelineWriter::ready(int id, int start, int end) {
+    if (end > start) {
+        interval(PROCESS_PID, id, "ready", -1, start, end);
+    }
+}
+
+void TimelineWriter::ioWait(int id, int device, int start, int end) {
+    if (end > start) {
+        std::string name = "io wait (device " + std::to_string(device) + ")";
+        interval(PROCESS_PID, id, name.c_str(), -1, start, end);
+    }
+}
+
+void TimelineWriter::io(int id, int device, int start, int end) {
+    if (end <= start) {
+        return;
+    }
+    if (device < 0) {
+        interval(PROCESS_PID, id, "io", -1, start, end);
+    } else {
+        std::string name = "io (device " + std::to_string(device) + ")";
+        interval(PROCESS_PID, id, name.c_str(), -1, start, end);
+    }
+}
+
+void TimelineWriter::close() {
+    if (!out.is_open()) {
+        return;
+    }
+    buffer += "\n]}\n";
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+    
+    out.close();
+    if (!out) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
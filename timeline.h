@@ -0,0 +1,57 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Streams what every CPU and process did over a run to a Chrome Trace Event
+// JSON file, for chrome://tracing, Perfetto or Speedscope. One time unit is
+// written as one microsecond. Cores are the threads of a "CPUs" process and
+// show runs, process switches and migrations; every process is a thread of a
+// "Processes" process and shows when it was ready, waiting for an I/O device
+// and doing I/O. Events are formatted into a buffer that is written out in
+// chunks, so a timeline never has to fit in memory.
+class TimelineWriter {
+private:
+    static constexpr std::size_t CHUNK_SIZE = std::size_t(1) << 20;
+    
+    std::ofstream out;
+    std::string path;
+    std::string buffer;
+    bool firstEvent;
+    std::vector<int> runStarts;     // Start of the current run on each core, -1 when idle
+    
+    void beginEvent();
+    void appendInt(long long value);
+    void appendString(const std::string& value);
+    // A complete ("X") event of duration end - start on thread tid of pid
+    void interval(int pid, long long tid, const char* name, int id, int start, int end);
+    void processName(int pid, const std::string& name);
+    void threadName(int pid, long long tid, const std::string& name);
+    void flushIfFull();
+    
+public:
+    // Creates the file and names the core tracks; throws std::runtime_error
+    TimelineWriter(const std::string& path, int numCores);
+    ~TimelineWriter();
+    
+    TimelineWriter(const TimelineWriter&) = delete;
+    TimelineWriter& operator=(const TimelineWriter&) = delete;
+    
+    void processArrived(int id, int time);
+    void runStarted(int core, int time);
+    void runEnded(int core, int id, int time);
+    void processSwitch(int core, int start, int duration);
+    void migration(int core, int id, int start, int end);
+    void ready(int id, int start, int end);
+    void ioWait(int id, int device, int start, int end);
+    void io(int id, int device, int start, int end);   // device is -1 for unlimited I/O
+    
+    // Ends the JSON document and closes the file; throws std::runtime_error
+    // if any write failed
+    void close();
+};
+
+#endif // TIMELINE_H
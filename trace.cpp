@@ -0,0 +1,130 @@
+#include "trace.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include "workload.h"
+
+namespace {
+
+std::size_t alignUp(std::size_t offset) {
+    return (offset + 7) & ~static_cast<std::size_t>(7);
+}
+
+void writePadding(std::ofstream& out, std::size_t written) {
+    static const char zeros[8] = {};
+    out.write(zeros, static_cast<std::streamsize>(alignUp(written) - written));
+}
+
+} // namespace
+
+bool isBinaryTrace(const char* data, std::size_t size) {
+    return size >= sizeof(TRACE_MAGIC) && std::memcmp(data, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0;
+}
+
+void writeTrace(const Workload& workload, const std::string& path) {
+    std::size_t count = workload.processes.size();
+    std::vector<std::int32_t> ids(count);
+    std::vector<std::int32_t> arrivalTimes(count);
+    std::vector<std::int8_t> nices(count);
+    std::vector<std::uint64_t> burstOffsets(count + 1);
+    std::vector<std::uint8_t> bursts;
+    std::uint8_t encoded[8];
+    
+    // Build the columns; bursts are already interleaved in the pool and only
+    // need re-encoding as varints
+    const ProcessColumns& processes = workload.processes;
+    for (std::size_t i = 0; i < count; i++) {
+        ids[i] = processes.ids[i];
+        arrivalTimes[i] = processes.arrivalTimes[i];
+        nices[i] = processes.nices[i];
+        burstOffsets[i] = bursts.size();
+        
+        BurstRange range = processes.bursts.range(i);
+        const std::uint8_t* cursor = range.begin;
+        while (cursor != range.end) {
+            std::int32_t burst;
+            cursor = decodeBurst(cursor, range.end, range.encoding, burst);
+            std::size_t n = encodeVarint(burst, encoded);
+            bursts.insert(bursts.end(), encoded, encoded + n);
+        }
+    }
+    burstOffsets[count] = bursts.size();
+    
+    TraceHeader header;
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header.version = TRACE_VERSION;
+    header.processSwitchTime = workload.processSwitchTime;
+    header.processCount = count;
+    header.burstBytes = bursts.size();
+    
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("cannot create " + path);
+    }
+    
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(ids.data()), count * sizeof(std::int32_t));
+    writePadding(out, count * sizeof(std::int32_t));
+    out.write(reinterpret_cast<const char*>(arrivalTimes.data()), count * sizeof(std::int32_t));
+    writePadding(out, count * sizeof(std::int32_t));
+    out.write(reinterpret_cast<const char*>(nices.data()), count);
+    writePadding(out, count);
+    out.write(reinterpret_cast<const char*>(burstOffsets.data()), (count + 1) * sizeof(std::uint64_t));
+    out.write(reinterpret_cast<const char*>(bursts.data()), bursts.size());
+    
+    if (!out.flush()) {
+        throw std::runtime_error("error writing " + path);
+    }
+}
+
+BinaryTrace::BinaryTrace(std::shared_ptr<MappedFile> file)
+    : file(std::move(file)) {
+    const char* data = this->file->data();
+    std::size_t size = this->file->size();
+    
+    TraceHeader header;
+    if (size < sizeof(header) || !isBinaryTrace(data, size)) {
+        throw std::runtime_error("not a binary trace");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != 1 && header.version != TRACE_VERSION) {
+        throw std::runtime_error("unsupported trace version " + std::to_string(header.version));
+    }
+    
+    processSwitchTime = header.processSwitchTime;
+    processCount = static_cast<std::size_t>(header.processCount);
+    
+    // Locate the columns and make sure they fit inside the file
+    std::size_t offset = sizeof(header);
+    std::size_t idsOffset = offset;
+    offset = alignUp(offset + processCount * sizeof(std::int32_t));
+    std::size_t arrivalsOffset = offset;
+    offset = alignUp(offset + processCount * sizeof(std::int32_t));
+    std::size_t nicesOffset = offset;
+    if (header.version >= 2) {
+        offset = alignUp(offset + processCount);
+    }
+    std::size_t offsetsOffset = offset;
+    offset += (processCount + 1) * sizeof(std::uint64_t);
+    std::size_t burstsOffset = offset;
+    
+    if (header.processCount > size || offset > size || size - offset < header.burstBytes) {
+        throw std::runtime_error("truncated binary trace");
+    }
+    
+    ids = reinterpret_cast<const std::int32_t*>(data + idsOffset);
+    arrivalTimes = reinterpret_cast<const std::int32_t*>(data + arrivalsOffset);
+    nices = header.version >= 2 ? reinterpret_cast<const std::int8_t*>(data + nicesOffset) : nullptr;
+    burstOffsets = reinterpret_cast<const std::uint64_t*>(data + offsetsOffset);
+    bursts = reinterpret_cast<const std::uint8_t*>(data + burstsOffset);
+    
+    // Burst ranges must be ordered and inside the burst column
+    std::uint64_t previous = 0;
+    for (std::size_t i = 0; i <= processCount; i++) {
+        if (burstOffsets[i] < previous || burstOffsets[i] > header.burstBytes) {
+            throw std::runtime_error("corrupt burst offsets in binary trace");
+        }
+        previous = burstOffsets[i];
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "burst_pool.h"
+#include "mapped_file.h"
+
+struct Workload;
+
+// Binary columnar workload format (version 2, little-endian):
+//
+//   TraceHeader
+//   int32  ids[processCount]                       (padded to 8 bytes)
+//   int32  arrivalTimes[processCount]              (padded to 8 bytes)
+//   int8   nices[processCount]                     (padded to 8 bytes; not in version 1)
+//   uint64 burstOffsets[processCount + 1]          byte offsets into the burst column
+//   uint8  bursts[burstBytes]                      zigzag varints: cpu, io, cpu, ..., cpu
+//
+// Every column is aligned so the loader can use it straight out of the mapping.
+struct TraceHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::int32_t processSwitchTime;
+    std::uint64_t processCount;
+    std::uint64_t burstBytes;
+};
+
+const char TRACE_MAGIC[8] = {'C', 'P', 'U', 'S', 'I', 'M', 'T', 'R'};
+const std::uint32_t TRACE_VERSION = 2;
+
+// True if the buffer starts with the binary trace magic
+bool isBinaryTrace(const char* data, std::size_t size);
+
+// Writes the workload in binary form; throws std::runtime_error on I/O failure
+void writeTrace(const Workload& workload, const std::string& path);
+
+// A binary trace mapped read-only into memory. Columns are accessed in place.
+class BinaryTrace {
+private:
+    std::shared_ptr<MappedFile> file;
+    int processSwitchTime;
+    std::size_t processCount;
+    const std::int32_t* ids;
+    const std::int32_t* arrivalTimes;
+    const std::int8_t* nices;       // Null for version 1 traces
+    const std::uint64_t* burstOffsets;
+    const std::uint8_t* bursts;
+
+public:
+    // Validates the header and column bounds; throws std::runtime_error if malformed
+    explicit BinaryTrace(std::shared_ptr<MappedFile> file);
+    
+    int getProcessSwitchTime() const { return processSwitchTime; }
+    std::size_t size() const { return processCount; }
+    int getId(std::size_t index) const { return ids[index]; }
+    int getArrivalTime(std::size_t index) const { return arrivalTimes[index]; }
+    int getNice(std::size_t index) const { return nices ? nices[index] : 0; }
+    BurstRange burstRange(std::size_t index) const {
+        return BurstRange{bursts + burstOffsets[index], bursts + burstOffsets[index + 1], BurstEncoding::VARINT};
+    }
+};
+
+#endif // TRACE_H
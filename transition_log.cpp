@@ -0,0 +1,123 @@
+#include "transition_log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const char LOG_MAGIC[8] = {'C', 'P', 'U', 'S', 'I', 'M', 'T', 'L'};
+const std::uint32_t LOG_VERSION = 1;
+
+struct LogHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+};
+
+} // namespace
+
+TransitionLog::TransitionLog(const std::string& path)
+    : ring(new TransitionRecord[CAPACITY]), out(path, std::ios::binary | std::ios::trunc), path(path),
+      tail(0), cachedHead(0), head(0), closing(false), failed(false) {
+    if (!out) {
+        throw std::runtime_error("cannot create " + path);
+    }
+    
+    LogHeader header;
+    std::memcpy(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+    header.version = LOG_VERSION;
+    header.recordSize = sizeof(TransitionRecord);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    
+    writer = std::thread(&TransitionLog::drain, this);
+}
+
+TransitionLog::~TransitionLog() {
+    if (writer.joinable()) {
+        closing.store(true, std::memory_order_release);
+        writer.join();
+    }
+}
+
+void TransitionLog::drain() {
+    for (;;) {
+        // Seeing closing first means every record was appended before tail is read
+        bool done = closing.load(std::memory_order_acquire);
+        std::uint64_t first = head.load(std::memory_order_relaxed);
+        std::uint64_t last = tail.load(std::memory_order_acquire);
+        if (first == last) {
+            if (done) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+        
+        // Up to the end of the ring in one write; the wrapped part goes next round
+        std::size_t offset = static_cast<std::size_t>(first & (CAPACITY - 1));
+        std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(last - first, CAPACITY - offset));
+        if (!failed.load(std::memory_order_relaxed) &&
+            !out.write(reinterpret_cast<const char*>(&ring[offset]),
+                       static_cast<std::streamsize>(count * sizeof(TransitionRecord)))) {
+            failed.store(true, std::memory_order_relaxed);
+        }
+        head.store(first + count, std::memory_order_release);
+    }
+}
+
+void TransitionLog::waitForSpace(std::uint64_t position) {
+    while ((cachedHead = head.load(std::memory_order_acquire)) + CAPACITY == position) {
+        std::this_thread::yield();
+    }
+}
+
+void TransitionLog::close() {
+    if (!writer.joinable()) {
+        return;
+    }
+    closing.store(true, std::memory_order_release);
+    writer.join();
+    
+    out.close();
+    if (failed.load(std::memory_order_relaxed) || !out) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
+
+void printTransitionLog(const std::string& path, std::ostream& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    
+    LogHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+        throw std::runtime_error(path + " is not a transition log");
+    }
+    if (header.version != LOG_VERSION || header.recordSize != sizeof(TransitionRecord)) {
+        throw std::runtime_error("unsupported transition log version in " + path);
+    }
+    
+    const std::size_t CHUNK = 1 << 16;
+    std::vector<TransitionRecord> records(CHUNK);
+    for (;;) {
+        in.read(reinterpret_cast<char*>(records.data()),
+                static_cast<std::streamsize>(CHUNK * sizeof(TransitionRecord)));
+        std::size_t count = static_cast<std::size_t>(in.gcount()) / sizeof(TransitionRecord);
+        for (std::size_t i = 0; i < count; i++) {
+            const TransitionRecord& record = records[i];
+            out << "At time " << record.time << ": Process " << record.id
+                << " moves from " << processStateToString(record.oldState) << " to "
+                << processStateToString(record.newState) << "\n";
+        }
+        if (count < CHUNK) {
+            break;
+        }
+    }
+    if (in.gcount() % sizeof(TransitionRecord) != 0) {
+        throw std::runtime_error("truncated transition log " + path);
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef TRANSITION_LOG_H
+#define TRANSITION_LOG_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include "event.h"
+#include "process.h"
+
+// One state change of a process, as logged in verbose mode
+struct TransitionRecord {
+    std::int32_t time;
+    std::int32_t id;
+    ProcessState oldState;
+    ProcessState newState;
+    EventType event;        // Event being handled when the change happened
+    std::uint8_t reserved;
+};
+
+static_assert(sizeof(TransitionRecord) == 12, "transition records are written as is");
+
+// Binary log of state transitions. The simulating thread appends fixed-size
+// records to a single-producer single-consumer ring buffer and a background
+// thread drains it to the file in large chunks, so logging a transition
+// costs a copy and two atomic operations instead of formatting text. The
+// producer only blocks when the writer falls a whole ring behind.
+//
+// The file is a header (magic, version, record size) followed by the records
+// in order, in host byte order; printTransitionLog turns it back into text.
+class TransitionLog {
+private:
+    static constexpr std::size_t CAPACITY = std::size_t(1) << 20;     // Records; a power of two
+    
+    std::unique_ptr<TransitionRecord[]> ring;
+    std::ofstream out;
+    std::string path;
+    
+    // Producer and consumer positions on separate cache lines
+    alignas(64) std::atomic<std::uint64_t> tail;    // Next record to append
+    std::uint64_t cachedHead;                       // Producer's last view of head
+    alignas(64) std::atomic<std::uint64_t> head;    // Next record to write out
+    std::atomic<bool> closing;
+    std::atomic<bool> failed;                       // A write to the file failed
+    std::thread writer;
+    
+    void drain();
+    void waitForSpace(std::uint64_t position);
+    
+public:
+    // Creates the file and starts the writer; throws std::runtime_error
+    explicit TransitionLog(const std::string& path);
+    ~TransitionLog();
+    
+    TransitionLog(const TransitionLog&) = delete;
+    TransitionLog& operator=(const TransitionLog&) = delete;
+    
+    void append(const TransitionRecord& record) {
+        std::uint64_t position = tail.load(std::memory_order_relaxed);
+        if (position - cachedHead == CAPACITY) {
+            waitForSpace(position);
+        }
+        ring[position & (CAPACITY - 1)] = record;
+        tail.store(position + 1, std::memory_order_release);
+    }
+    
+    // Writes out every record appended so far and closes the file; throws
+    // std::runtime_error if any write failed
+    void close();
+};
+
+// Prints a transition log as the text verbose mode writes, one line per
+// record. Reads the file in chunks; throws std::runtime_error if it is not
+// a transition log.
+void printTransitionLog(const std::string& path, std::ostream& out);
+
+#endif // TRANSITION_LOG_H
@@ -0,0 +1,44 @@
+#include "workload.h"
+#include <algorithm>
+#include <numeric>
+#include "trace.h"
+
+void ProcessColumns::add(int id, int arrivalTime, int nice, const std::vector<int>& cpuBursts,
+                         const std::vector<int>& ioBursts) {
+    ids.push_back(id);
+    arrivalTimes.push_back(arrivalTime);
+    nices.push_back(static_cast<std::int8_t>(nice));
+    bursts.add(cpuBursts, ioBursts);
+}
+
+void ProcessColumns::reserve(std::size_t count) {
+    ids.reserve(count);
+    arrivalTimes.reserve(count);
+    nices.reserve(count);
+    bursts.reserve(count);
+}
+
+void Workload::indexArrivals() {
+    arrivalOrder.clear();
+    
+    std::size_t count = trace ? trace->size() : processes.size();
+    auto arrivalTime = [this](std::size_t i) {
+        return trace ? trace->getArrivalTime(i) : processes.arrivalTimes[i];
+    };
+    
+    // Most inputs are already in arrival order and need no index at all
+    bool sorted = true;
+    for (std::size_t i = 1; i < count && sorted; i++) {
+        sorted = arrivalTime(i - 1) <= arrivalTime(i);
+    }
+    if (sorted) {
+        return;
+    }
+    
+    arrivalOrder.resize(count);
+    std::iota(arrivalOrder.begin(), arrivalOrder.end(), 0);
+    std::stable_sort(arrivalOrder.begin(), arrivalOrder.end(),
+                     [&](std::uint32_t a, std::uint32_t b) {
+                         return arrivalTime(a) < arrivalTime(b);
+                     });
+}
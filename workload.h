@@ -0,0 +1,59 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "burst_pool.h"
+
+class BinaryTrace;
+class MappedFile;
+
+// Parameters of a synthetic workload generated on the fly by RandomArrivalSource
+struct GeneratorSettings {
+    int numProcesses;
+    std::uint64_t seed;
+    
+    GeneratorSettings() : numProcesses(0), seed(0) {}
+};
+
+// Processes parsed into memory, stored as columns. The bursts of all of them
+// share one BurstPool, which must be finished once the last process is added.
+struct ProcessColumns {
+    std::vector<int> ids;
+    std::vector<int> arrivalTimes;
+    std::vector<std::int8_t> nices;
+    BurstPool bursts;
+    
+    std::size_t size() const { return ids.size(); }
+    void add(int id, int arrivalTime, int nice, const std::vector<int>& cpuBursts,
+             const std::vector<int>& ioBursts);
+    void reserve(std::size_t count);
+};
+
+// Read-only description of a simulation input. A single Workload is shared by
+// every simulation run; each run pulls processes from it through its own
+// ArrivalSource. Exactly one representation is used:
+//   - processes: text input parsed into memory
+//   - trace:     binary trace mapped in place
+//   - text:      text input kept mapped and parsed lazily by each run
+//   - generator: random processes produced on the fly
+struct Workload {
+    int processSwitchTime;
+    ProcessColumns processes;
+    std::shared_ptr<const BinaryTrace> trace;
+    std::shared_ptr<const MappedFile> text;
+    bool generated;
+    GeneratorSettings generator;
+    
+    // Input positions of processes/trace entries sorted by arrival time (stable);
+    // empty when the input is already in arrival order
+    std::vector<std::uint32_t> arrivalOrder;
+    
+    Workload() : processSwitchTime(0), generated(false) {}
+    
+    // Fills arrivalOrder for in-memory and trace input
+    void indexArrivals();
+};
+
+#endif // WORKLOAD_H